@@ -0,0 +1,114 @@
+#include <complex>
+#include <stdexcept>
+#include "analysis.hpp"
+#include "convert.hpp"
+#include "fft.hpp"
+#include "parallel.hpp"
+
+ChannelMix parseChannelMix(const std::string& name)
+{
+    if (name == "none")
+        return ChannelMix::None;
+    if (name == "downmix")
+        return ChannelMix::Downmix;
+    if (name == "midside")
+        return ChannelMix::MidSide;
+    throw std::runtime_error("analysis: unknown channel mix " + name);
+}
+
+std::vector<std::string> spectrumLabels(uint32_t channels, ChannelMix mix)
+{
+    std::vector<std::string> labels;
+    if (channels == 2) {
+        labels.push_back("L");
+        labels.push_back("R");
+    } else {
+        for (uint32_t c = 0; c < channels; ++c)
+            labels.push_back("ch" + std::to_string(c + 1));
+    }
+    if (mix == ChannelMix::Downmix) {
+        labels.push_back("downmix");
+    } else if (mix == ChannelMix::MidSide) {
+        labels.push_back("mid");
+        labels.push_back("side");
+    }
+    return labels;
+}
+
+ChannelSpectra analyzeChannels(const AudioData& data, ChannelMix mix, unsigned threads,
+                               const WindowSpec& window)
+{
+    const uint32_t channels = data.channels;
+    const size_t n = data.frames();
+    if (mix == ChannelMix::MidSide && channels != 2)
+        throw std::runtime_error("analysis: mid/side needs a stereo input");
+
+    ChannelSpectra out;
+    out.labels = spectrumLabels(channels, mix);
+    out.mag.resize(out.labels.size());
+    if (n == 0 || channels == 0)
+        return out;
+    // fft() is radix-2, so the transform is zero-padded to a power of two;
+    // the window still spans just the signal
+    const size_t size = nextPowerOfTwo(n);
+    out.binHz = static_cast<double>(data.sampleRate) / size;
+
+    // a rectangular window needs no table; packComplex skips the multiply
+    std::shared_ptr<const WindowTable> table;
+    const float* w = nullptr;
+    double gain = static_cast<double>(n);
+    if (window.type != WindowType::Rectangular) {
+        table = windowTable(window, n);
+        w = table->values.data();
+        gain = table->sum;
+    }
+
+    // each channel is read straight from the decoded buffer while packing
+    const bool planar = data.layout == SampleLayout::Planar;
+
+    // keep the half spectra only while the mixes still need them
+    const size_t bins = size / 2 + 1;
+    const bool keepComplex = mix != ChannelMix::None;
+    std::vector<std::vector<std::complex<double>>> halves(keepComplex ? channels : 0);
+
+    parallelFor(channels, [&](size_t c) {
+        std::vector<std::complex<double>> xs(size);
+        if (planar)
+            packComplex(data.plane(c), 1, n, w, 1.0, xs.data());
+        else
+            packComplex(data.samples.data() + c, channels, n, w, 1.0, xs.data());
+        fft(xs);
+        xs.resize(bins);
+
+        out.mag[c].resize(bins);
+        complexToSpectrum(xs.data(), bins, 2.0 / gain, SpectrumScale::Magnitude, 0,
+                          out.mag[c].data());
+        if (keepComplex)
+            halves[c] = std::move(xs);
+    }, threads);
+
+    // the mixes are formed in place in the channels' half spectra, which
+    // are not needed afterwards
+    if (mix == ChannelMix::Downmix) {
+        std::vector<std::complex<double>>& sum = halves[0];
+        for (uint32_t c = 1; c < channels; ++c)
+            for (size_t k = 0; k < bins; ++k)
+                sum[k] += halves[c][k];
+        out.mag[channels].resize(bins);
+        complexToSpectrum(sum.data(), bins, 2.0 / (gain * channels), SpectrumScale::Magnitude, 0,
+                          out.mag[channels].data());
+    } else if (mix == ChannelMix::MidSide) {
+        std::vector<std::complex<double>>& left  = halves[0];
+        std::vector<std::complex<double>>& right = halves[1];
+        for (size_t k = 0; k < bins; ++k) {
+            const std::complex<double> l = left[k];
+            left[k]  = l + right[k];
+            right[k] = l - right[k];
+        }
+        out.mag[2].resize(bins);
+        out.mag[3].resize(bins);
+        complexToSpectrum(left.data(), bins, 1.0 / gain, SpectrumScale::Magnitude, 0, out.mag[2].data());
+        complexToSpectrum(right.data(), bins, 1.0 / gain, SpectrumScale::Magnitude, 0, out.mag[3].data());
+    }
+    return out;
+}
@@ -0,0 +1,43 @@
+#ifndef ANALYSIS_HPP
+#define ANALYSIS_HPP
+
+#include <string>
+#include <vector>
+#include "audio.hpp"
+#include "window.hpp"
+
+// Spectra derived from the per-channel transforms on top of the channels'
+// own: the mean of all channels, or mid (L+R)/2 and side (L-R)/2 of a
+// stereo pair.
+enum class ChannelMix { None, Downmix, MidSide };
+
+// Parses "none", "downmix" or "midside".
+ChannelMix parseChannelMix(const std::string& name);
+
+// Single-sided magnitude spectra 2|X[k]|/sum(w), so a full-scale sinusoid
+// reads 1.0 under any window; one per channel followed by the mixes, all
+// over the same frequency axis.
+struct ChannelSpectra {
+    double binHz = 0;                      // bin k sits at k * binHz
+    std::vector<std::string> labels;       // "L", "R" or "ch1", ...; "mid", "side", "downmix"
+    std::vector<std::vector<double>> mag;
+
+    size_t bins() const { return mag.empty() ? 0 : mag[0].size(); }
+};
+
+// Labels analyzeChannels() gives for `channels` channels and `mix`.
+std::vector<std::string> spectrumLabels(uint32_t channels, ChannelMix mix);
+
+// Transforms each channel of `data` on its own, concurrently on up to
+// `threads` threads (0 = workerCount()). packComplex() reads every channel
+// straight out of interleaved or planar samples into the transform input,
+// so no deinterleaved copy is made. A transform is linear, so the mixes are
+// combined from the channels' complex spectra in the same pass rather
+// than transformed again. The window spans the whole signal and is applied
+// while packing; the transform is zero-padded to the next power of two.
+// MidSide needs exactly two channels.
+ChannelSpectra analyzeChannels(const AudioData& data, ChannelMix mix = ChannelMix::None,
+                               unsigned threads = 0,
+                               const WindowSpec& window = WindowSpec(WindowType::Rectangular));
+
+#endif
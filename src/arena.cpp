@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "arena.hpp"
+
+// Every block is preceded by a header holding its size, padded so the
+// block itself stays 64-byte aligned.
+static const size_t ALIGN  = 64;
+static const size_t HEADER = ALIGN;
+
+static size_t alignUp(size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+
+Arena::Arena(size_t chunkSize) : chunkSize_(alignUp(chunkSize)) {}
+
+Arena::~Arena()
+{
+    for (auto& c : chunks_)
+        std::free(c.data);
+}
+
+size_t Arena::blockSize(const void* p)
+{
+    return *reinterpret_cast<const size_t*>(static_cast<const char*>(p) - HEADER);
+}
+
+void* Arena::allocate(size_t size)
+{
+    const size_t need = HEADER + alignUp(size ? size : 1);
+
+    // move to the next chunk that fits, allocating one when none does
+    while (chunks_.empty() || offset_ + need > chunks_[current_].size) {
+        if (!chunks_.empty() && current_ + 1 < chunks_.size()
+            && chunks_[current_ + 1].size >= need) {
+            ++current_;
+        } else {
+            Chunk c;
+            c.size = std::max(chunkSize_, need);
+            void* mem = nullptr;
+            if (posix_memalign(&mem, ALIGN, c.size) != 0)
+                throw std::bad_alloc();
+            c.data = static_cast<char*>(mem);
+            size_t at = chunks_.empty() ? 0 : current_ + 1;
+            chunks_.insert(chunks_.begin() + at, c);
+            current_ = at;
+            stats_.reservedBytes += c.size;
+            stats_.chunks = chunks_.size();
+        }
+        offset_ = 0;
+    }
+
+    char* block = chunks_[current_].data + offset_ + HEADER;
+    *reinterpret_cast<size_t*>(block - HEADER) = size;
+    offset_ += need;
+    last_ = block;
+
+    ++stats_.allocations;
+    stats_.bytesInUse += need;
+    stats_.peakBytes = std::max(stats_.peakBytes, stats_.bytesInUse);
+    return block;
+}
+
+void* Arena::reallocate(void* p, size_t size)
+{
+    if (!p)
+        return allocate(size);
+    ++stats_.reallocations;
+
+    const size_t old = blockSize(p);
+    char* block = static_cast<char*>(p);
+
+    // the most recent block can grow or shrink in place
+    if (block == last_) {
+        const size_t start = block - HEADER - chunks_[current_].data;
+        const size_t need  = HEADER + alignUp(size ? size : 1);
+        if (start + need <= chunks_[current_].size) {
+            stats_.bytesInUse = stats_.bytesInUse - (offset_ - start) + need;
+            stats_.peakBytes  = std::max(stats_.peakBytes, stats_.bytesInUse);
+            offset_ = start + need;
+            *reinterpret_cast<size_t*>(block - HEADER) = size;
+            return block;
+        }
+    }
+
+    void* moved = allocate(size);
+    --stats_.allocations;
+    std::memcpy(moved, p, std::min(old, size));
+    return moved;
+}
+
+void Arena::free(void* p)
+{
+    if (!p)
+        return;
+    ++stats_.frees;
+
+    // only the top of the stack can be handed back before reset()
+    if (static_cast<char*>(p) == last_) {
+        const size_t start = last_ - HEADER - chunks_[current_].data;
+        stats_.bytesInUse -= offset_ - start;
+        offset_ = start;
+        last_ = nullptr;
+    }
+}
+
+void Arena::reset()
+{
+    current_ = 0;
+    offset_  = 0;
+    last_    = nullptr;
+    stats_.bytesInUse = 0;
+    ++stats_.resets;
+}
+
+// the dr_libs expect NULL on failure, not an exception
+void* Arena::onMalloc(size_t size, void* self)
+{
+    try {
+        return static_cast<Arena*>(self)->allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* Arena::onRealloc(void* p, size_t size, void* self)
+{
+    try {
+        return static_cast<Arena*>(self)->reallocate(p, size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void Arena::onFree(void* p, void* self)
+{
+    static_cast<Arena*>(self)->free(p);
+}
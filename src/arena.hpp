@@ -0,0 +1,116 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+struct ArenaStats {
+    size_t allocations   = 0;
+    size_t reallocations = 0;
+    size_t frees         = 0;
+    size_t resets        = 0;
+    size_t bytesInUse    = 0;   // since the last reset
+    size_t peakBytes     = 0;   // highest bytesInUse ever seen
+    size_t reservedBytes = 0;   // memory held in chunks
+    size_t chunks        = 0;
+};
+
+// Bump allocator for one decode job. Memory comes from large chunks that
+// are kept across reset(), so after the first few files a batch stops
+// touching the global heap. Blocks are 64-byte aligned. free() only gives
+// memory back when it is the most recent block; everything else is
+// reclaimed by reset(), which is O(1).
+//
+// Not thread-safe: use one arena per worker thread.
+class Arena {
+public:
+    explicit Arena(size_t chunkSize = 4 << 20);
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size);
+    void* reallocate(void* p, size_t size);
+    void  free(void* p);
+
+    // Invalidates every block handed out so far.
+    void reset();
+
+    const ArenaStats& stats() const { return stats_; }
+
+    // Fills a drwav/drmp3/drflac_allocation_callbacks struct; all three
+    // share the same layout.
+    template <typename Callbacks>
+    Callbacks callbacks()
+    {
+        Callbacks cb;
+        cb.pUserData = this;
+        cb.onMalloc  = &Arena::onMalloc;
+        cb.onRealloc = &Arena::onRealloc;
+        cb.onFree    = &Arena::onFree;
+        return cb;
+    }
+
+private:
+    struct Chunk {
+        char*  data;
+        size_t size;
+    };
+
+    static void* onMalloc(size_t size, void* self);
+    static void* onRealloc(void* p, size_t size, void* self);
+    static void  onFree(void* p, void* self);
+
+    static size_t blockSize(const void* p);
+
+    std::vector<Chunk> chunks_;
+    size_t current_ = 0;    // chunk being carved
+    size_t offset_  = 0;    // first free byte in chunks_[current_]
+    char*  last_    = nullptr;
+    size_t chunkSize_;
+    ArenaStats stats_;
+};
+
+// std::allocator replacement that draws from an Arena, or from the global
+// heap when no arena is given. Either way blocks are 64-byte aligned.
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    Arena* arena;
+
+    ArenaAllocator(Arena* a = nullptr) : arena(a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n)
+    {
+        if (arena)
+            return static_cast<T*>(arena->allocate(n * sizeof(T)));
+        // same 64-byte alignment as arena blocks
+        void* p = nullptr;
+        if (posix_memalign(&p, 64, n * sizeof(T)) != 0)
+            throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t)
+    {
+        if (arena)
+            arena->free(p);
+        else
+            std::free(p);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+#endif
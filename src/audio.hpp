@@ -1,17 +1,156 @@
 #ifndef AUDIO_HPP
 #define AUDIO_HPP
 
+#include <memory>
 #include  <string>
 #include <vector>
+#include "arena.hpp"
+
+typedef std::vector<float, ArenaAllocator<float>> SampleBuffer;
+
+enum class SampleLayout { Interleaved, Planar };
 
 struct AudioData {
-    std::vector<float> samples;
+    // samples live in `arena` when one is given, on the heap otherwise
+    explicit AudioData(Arena* arena = nullptr) : samples(ArenaAllocator<float>(arena)) {}
+
+    // Interleaved: frame f of channel c is samples[f * channels + c].
+    // Planar: channel c is planeFrames contiguous floats at plane(c). Planes
+    // are planeStride floats apart, a multiple of 16, so with the 64-byte
+    // aligned buffer every plane starts on a 64-byte boundary.
+    SampleBuffer samples;
     uint32_t sampleRate = 0;
     uint32_t channels   = 0;
+    SampleLayout layout = SampleLayout::Interleaved;
+    size_t planeStride  = 0;
+    size_t planeFrames  = 0;
+
+    size_t frames() const
+    {
+        if (layout == SampleLayout::Planar)
+            return planeFrames;
+        return channels ? samples.size() / channels : 0;
+    }
+    float* plane(uint32_t c) { return samples.data() + c * planeStride; }
+    const float* plane(uint32_t c) const { return samples.data() + c * planeStride; }
+};
+
+// Non-owning, strided window onto one signal: sample i is data[i * stride].
+// Cheap to copy; slicing and picking channels never touch the samples.
+struct AudioView {
+    AudioView() {}
+    AudioView(const float* data, size_t frames, size_t stride, uint32_t sampleRate)
+        : data(data), frames(frames), stride(stride), sampleRate(sampleRate) {}
+
+    const float* data   = nullptr;
+    size_t   frames     = 0;
+    size_t   stride     = 1;
+    uint32_t sampleRate = 0;
+
+    float operator[](size_t i) const { return data[i * stride]; }
+    double duration() const { return sampleRate ? static_cast<double>(frames) / sampleRate : 0.0; }
+
+    // Frames [first, first + count), clamped to the view.
+    AudioView slice(size_t first, size_t count) const
+    {
+        first = first < frames ? first : frames;
+        count = count < frames - first ? count : frames - first;
+        return AudioView(data + first * stride, count, stride, sampleRate);
+    }
+
+    // The part between `start` and `start + length` seconds.
+    AudioView sliceSeconds(double start, double length) const
+    {
+        return slice(static_cast<size_t>(start * sampleRate), static_cast<size_t>(length * sampleRate));
+    }
+};
+
+// Channel c of the data, in either layout.
+AudioView channelView(const AudioData& data, uint32_t c);
+
+// The whole sample buffer read as one signal. For interleaved data with
+// several channels this mixes them sample by sample, as main() has always
+// analysed files.
+AudioView interleavedView(const AudioData& data);
+
+// Stream parameters read from the file headers, without decoding audio.
+struct AudioInfo {
+    std::string format;            // "wav", "w64", "rf64", "mp3" or "flac"
+    uint32_t sampleRate    = 0;
+    uint32_t channels      = 0;
+    uint32_t bitsPerSample = 0;    // 0 for mp3
+    uint64_t frameCount    = 0;    // PCM frames per channel
+    double   duration      = 0;    // seconds
+    std::string error;             // set by probeAudioFiles() when a file fails
 };
 
 inline std::string toLower(std::string s);
 
-AudioData loadAudioFile(const std::string& path);
+// Decodes a whole file to f32 in the requested layout; planar output is
+// deinterleaved chunk by chunk as it is decoded. The file is read through
+// a ReadAhead, so I/O for the next blocks overlaps decoding. With an arena,
+// both the decoder's internal allocations and the returned samples come
+// from it; the arena must outlive the AudioData and must not be reset
+// while it is in use. FLAC is decoded by loadFlacParallel() on `threads`
+// threads (0 = all hardware threads); callers already running one file per
+// worker pass 1.
+AudioData loadAudioFile(const std::string& path, Arena* arena = nullptr,
+                        SampleLayout layout = SampleLayout::Interleaved,
+                        unsigned threads = 0);
+
+// Decodes only `durationSec` seconds starting at `startSec` (a negative
+// duration reads to the end). WAV and FLAC seek with drwav_seek_to_pcm_frame
+// and drflac_seek_to_pcm_frame, so the cost follows the window length; MP3
+// still decodes (without keeping) everything before the window.
+AudioData loadAudioRange(const std::string& path, double startSec, double durationSec,
+                         Arena* arena = nullptr,
+                         SampleLayout layout = SampleLayout::Interleaved);
+
+// Converts interleaved data to the planar layout in place.
+void makePlanar(AudioData& data);
+
+// Reads only the headers: the WAV fmt/data chunks, the first MP3 frame plus
+// its Xing/LAME tag, or the FLAC STREAMINFO. MP3s without a Xing tag fall
+// back to a header-only frame scan to count their frames.
+AudioInfo probeAudioFile(const std::string& path);
+
+// Probes many files in parallel (0 = all hardware threads). Failures do not
+// stop the batch, they are reported in AudioInfo::error.
+std::vector<AudioInfo> probeAudioFiles(const std::vector<std::string>& paths,
+                                       unsigned threads = 0);
+
+// Decodes a FLAC file on `threads` threads (0 = all hardware threads). The
+// stream is cut at seekpoints (or block boundaries when there is no
+// SEEKTABLE) and every range is decoded into its own slice of the output.
+// Throws if any frame fails its CRC check. The arena (optional) holds the
+// output; the per-range decoders use the default allocator.
+AudioData loadFlacParallel(const std::string& path, unsigned threads = 0,
+                           Arena* arena = nullptr,
+                           SampleLayout layout = SampleLayout::Interleaved);
+
+// Decodes a file front to back a block at a time, holding only the decoder
+// state: the counterpart of loadAudioFile() for work that never needs the
+// whole signal at once. Accepts the same formats.
+class AudioFileReader {
+public:
+    explicit AudioFileReader(const std::string& path);
+    ~AudioFileReader();
+    AudioFileReader(const AudioFileReader&) = delete;
+    AudioFileReader& operator=(const AudioFileReader&) = delete;
+
+    uint32_t sampleRate() const { return sampleRate_; }
+    uint32_t channels() const { return channels_; }
+
+    // Decodes up to `frames` interleaved f32 frames into dst. Returns fewer
+    // only at the end of the file.
+    uint64_t read(float* dst, uint64_t frames);
+
+private:
+    struct Decoder;     // one of the dr_libs decoders and its input
+
+    std::unique_ptr<Decoder> decoder_;
+    uint32_t sampleRate_ = 0;
+    uint32_t channels_   = 0;
+};
 
 #endif
\ No newline at end of file
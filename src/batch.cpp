@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <dirent.h>
+#include <glob.h>
+#include <sys/stat.h>
+#include "analysis.hpp"
+#include "arena.hpp"
+#include "batch.hpp"
+#include "parallel.hpp"
+
+static std::string formatOf(const std::string& path)
+{
+    std::string ext = path.substr(path.find_last_of('.') + 1);
+    for (auto& c : ext)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return ext;
+}
+
+static bool isAudioPath(const std::string& path)
+{
+    const std::string ext = formatOf(path);
+    return ext == "wav" || ext == "w64" || ext == "rf64" || ext == "mp3" || ext == "flac";
+}
+
+static void walkDirectory(const std::string& dir, std::vector<std::string>& out)
+{
+    DIR* d = opendir(dir.c_str());
+    if (!d)
+        return;
+    while (dirent* entry = readdir(d)) {
+        const std::string name = entry->d_name;
+        if (name == "." || name == "..")
+            continue;
+        const std::string path = dir + "/" + name;
+        // lstat so symlinked directories cannot loop the walk
+        struct stat st;
+        if (lstat(path.c_str(), &st) != 0)
+            continue;
+        if (S_ISDIR(st.st_mode))
+            walkDirectory(path, out);
+        else if (isAudioPath(path))
+            out.push_back(path);
+    }
+    closedir(d);
+}
+
+std::vector<std::string> batchInputs(const std::string& spec)
+{
+    std::vector<std::string> paths;
+
+    if (!spec.empty() && spec[0] == '@') {
+        std::ifstream manifest(spec.substr(1));
+        if (!manifest)
+            throw std::runtime_error("batch: cannot open manifest " + spec.substr(1));
+        std::string line;
+        while (std::getline(manifest, line)) {
+            line = line.substr(0, line.find('#'));
+            const size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos)
+                continue;
+            const size_t last = line.find_last_not_of(" \t\r");
+            paths.push_back(line.substr(first, last - first + 1));
+        }
+        return paths;
+    }
+
+    struct stat st;
+    if (stat(spec.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        walkDirectory(spec, paths);
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    glob_t matches;
+    const int rc = glob(spec.c_str(), 0, nullptr, &matches);
+    if (rc != 0 && rc != GLOB_NOMATCH) {
+        globfree(&matches);
+        throw std::runtime_error("batch: cannot expand " + spec);
+    }
+    for (size_t i = 0; rc == 0 && i < matches.gl_pathc; ++i)
+        paths.push_back(matches.gl_pathv[i]);
+    globfree(&matches);
+    return paths;
+}
+
+static void analyzeFile(const std::string& path, size_t peaks, uint32_t rate,
+                        ResampleQuality quality, BatchResult& result)
+{
+    // one arena per worker, recycled from file to file
+    static thread_local Arena arena;
+
+    result.path = path;
+    result.info.format = formatOf(path);
+    try {
+        arena.reset();
+        if (rate > 0) {
+            // the headers describe the file; the samples come converted
+            result.info = probeAudioFile(path);
+            result.info.format = formatOf(path);
+        }
+        // the pool already spreads files over the workers, so FLAC is
+        // decoded on the calling thread rather than fanning out again
+        AudioData data = rate > 0 ? loadAudioResampled(path, rate, quality, &arena, 1)
+                                  : loadAudioFile(path, &arena, SampleLayout::Interleaved, 1);
+        if (rate == 0) {
+            result.info.sampleRate = data.sampleRate;
+            result.info.channels   = data.channels;
+            result.info.frameCount = data.frames();
+            result.info.duration   = data.sampleRate ? static_cast<double>(data.frames()) / data.sampleRate : 0;
+        }
+
+        // channel-aware like the interactive mode; the pool already runs
+        // one file per worker, so the channels are transformed in turn
+        // the Hann window keeps leakage out of the peak interpolation
+        const ChannelSpectra spectra = analyzeChannels(
+            data, data.channels > 1 ? ChannelMix::Downmix : ChannelMix::None, 1,
+            WindowSpec(WindowType::Hann));
+        const std::vector<double>& mag = spectra.mag.back();
+        result.peaks = findPeaks(mag.data(), mag.size(), spectra.binHz, peaks);
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+}
+
+std::vector<BatchResult> runBatch(const std::vector<std::string>& paths, unsigned threads,
+                                  size_t peaks, uint32_t rate, ResampleQuality quality)
+{
+    std::vector<BatchResult> results(paths.size());
+
+    // Deal files out smallest first, so every worker's deque ends with its
+    // largest file. Owners take from the back and start the long files
+    // early; idle workers steal from the front and drain the short ones,
+    // so a long file never keeps short ones waiting.
+    std::vector<off_t> sizes(paths.size(), 0);
+    for (size_t i = 0; i < paths.size(); ++i) {
+        struct stat st;
+        if (stat(paths[i].c_str(), &st) == 0)
+            sizes[i] = st.st_size;
+    }
+    std::vector<size_t> order(paths.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return sizes[a] < sizes[b]; });
+
+    TaskPool pool(threads);
+    for (size_t i : order)
+        pool.submit([&paths, &results, i, peaks, rate, quality] {
+            analyzeFile(paths[i], peaks, rate, quality, results[i]);
+        });
+    pool.wait();
+    return results;
+}
+
+void writeBatchResults(const std::string& path, const std::vector<BatchResult>& results,
+                       size_t peaks)
+{
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f)
+        throw std::runtime_error("batch: cannot write " + path);
+
+    std::fprintf(f, "path\tformat\tsample_rate\tchannels\tframes\tduration\tpeak_hz\tpeak_magnitude");
+    for (size_t p = 2; p <= peaks; ++p)
+        std::fprintf(f, "\tpeak%zu_hz\tpeak%zu_magnitude", p, p);
+    std::fprintf(f, "\terror\n");
+    for (const BatchResult& r : results) {
+        std::fprintf(f, "%s\t%s\t%u\t%u\t%llu\t%.6f",
+                     r.path.c_str(), r.info.format.c_str(), r.info.sampleRate, r.info.channels,
+                     static_cast<unsigned long long>(r.info.frameCount), r.info.duration);
+        for (size_t p = 0; p < std::max<size_t>(peaks, 1); ++p) {
+            if (p < r.peaks.size())
+                std::fprintf(f, "\t%.3f\t%.6g", r.peaks[p].frequency, r.peaks[p].magnitude);
+            else
+                std::fprintf(f, "\t\t");
+        }
+        std::fprintf(f, "\t%s\n", r.error.c_str());
+    }
+
+    if (std::fclose(f) != 0)
+        throw std::runtime_error("batch: cannot write " + path);
+}
@@ -0,0 +1,40 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <string>
+#include <vector>
+#include "audio.hpp"
+#include "peaks.hpp"
+#include "resample.hpp"
+
+// Outcome of decoding and transforming one file in a batch.
+struct BatchResult {
+    std::string path;
+    AudioInfo   info;              // format, rate, channels, frames, duration
+    std::vector<Peak> peaks;       // strongest peaks of the downmix, interpolated
+    std::string error;             // set when the file could not be analyzed
+};
+
+// Expands a batch input into file paths: "@list.txt" reads a manifest with
+// one path per line ('#' starts a comment), a directory is walked
+// recursively for .wav/.w64/.rf64/.mp3/.flac files, anything else is a
+// glob pattern. Directory and glob matches come back sorted.
+std::vector<std::string> batchInputs(const std::string& spec);
+
+// Decodes and transforms every file on a TaskPool of `threads` workers
+// (0 = one per core) and keeps up to `peaks` peaks per file. A nonzero
+// `rate` converts every file to it while decoding, so spectra of a mixed
+// corpus share one frequency axis; BatchResult::info still describes the
+// file itself. Results come back in input order; a failing file only sets
+// its own error.
+std::vector<BatchResult> runBatch(const std::vector<std::string>& paths,
+                                  unsigned threads = 0, size_t peaks = 1, uint32_t rate = 0,
+                                  ResampleQuality quality = ResampleQuality::Medium);
+
+// Writes results as tab-separated values with a header line. The first
+// peak goes to peak_hz and peak_magnitude, further ones to peak2_hz,
+// peak2_magnitude and so on, up to `peaks`; missing peaks are left empty.
+void writeBatchResults(const std::string& path, const std::vector<BatchResult>& results,
+                       size_t peaks = 1);
+
+#endif
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "cachedir.hpp"
+
+void ensureCacheDir(const std::string& dir)
+{
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+        throw std::runtime_error("cannot create cache directory: " + dir);
+}
+
+void touchCacheEntry(const std::string& path)
+{
+    utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+}
+
+bool writeCacheEntry(const std::string& path, const void* header, size_t headerSize,
+                     const void* payload, size_t payloadSize)
+{
+    const std::string tmp = path + ".tmp." + std::to_string(getpid());
+
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = std::fwrite(header, 1, headerSize, f) == headerSize
+           && (payloadSize == 0 || std::fwrite(payload, 1, payloadSize, f) == payloadSize);
+    ok = (std::fclose(f) == 0) && ok;
+
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void evictCacheEntries(const std::string& dir, const std::string& suffix, uint64_t maxBytes)
+{
+    struct Entry {
+        std::string path;
+        uint64_t size;
+        struct timespec used;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+
+    DIR* d = opendir(dir.c_str());
+    if (!d)
+        return;
+    while (struct dirent* e = readdir(d)) {
+        std::string name = e->d_name;
+        if (name.size() < suffix.size()
+            || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+            continue;
+        std::string path = dir + "/" + name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+            continue;
+        entries.push_back(Entry{path, static_cast<uint64_t>(st.st_size), st.st_mtim});
+        total += st.st_size;
+    }
+    closedir(d);
+
+    if (total <= maxBytes)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.used.tv_sec != b.used.tv_sec)
+            return a.used.tv_sec < b.used.tv_sec;
+        return a.used.tv_nsec < b.used.tv_nsec;
+    });
+    for (const auto& e : entries) {
+        if (total <= maxBytes)
+            break;
+        if (std::remove(e.path.c_str()) == 0)
+            total -= e.size;
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef CACHEDIR_HPP
+#define CACHEDIR_HPP
+
+#include <cstdint>
+#include <string>
+
+// Helpers shared by the on-disk caches. A cache is a flat directory whose
+// entries end in a fixed suffix; an entry's mtime is its last use.
+
+// Creates `dir` if needed, throws when that fails.
+void ensureCacheDir(const std::string& dir);
+
+// Marks an entry as just used.
+void touchCacheEntry(const std::string& path);
+
+// Writes header + payload to a temporary file and renames it into place.
+// Returns false (and leaves nothing behind) on any error.
+bool writeCacheEntry(const std::string& path, const void* header, size_t headerSize,
+                     const void* payload, size_t payloadSize);
+
+// Deletes the least recently used `suffix` entries of `dir` until the
+// ones left add up to at most maxBytes.
+void evictCacheEntries(const std::string& dir, const std::string& suffix, uint64_t maxBytes);
+
+#endif
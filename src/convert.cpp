@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "convert.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSE3__)
+#include <pmmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+static void deinterleaveStereo(const float* src, size_t frames, float* left, float* right)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 4 <= frames; i += 4) {
+        __m128 a = _mm_loadu_ps(src + 2 * i);        // L0 R0 L1 R1
+        __m128 b = _mm_loadu_ps(src + 2 * i + 4);    // L2 R2 L3 R3
+        _mm_storeu_ps(left  + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+#endif
+    for (; i < frames; ++i) {
+        left[i]  = src[2 * i];
+        right[i] = src[2 * i + 1];
+    }
+}
+
+void deinterleave(const float* src, size_t frames, uint32_t channels, float* const* dst)
+{
+    if (channels == 1) {
+        std::memcpy(dst[0], src, frames * sizeof(float));
+    } else if (channels == 2) {
+        deinterleaveStereo(src, frames, dst[0], dst[1]);
+    } else {
+        for (uint32_t c = 0; c < channels; ++c) {
+            float* out = dst[c];
+            const float* in = src + c;
+            for (size_t i = 0; i < frames; ++i)
+                out[i] = in[i * channels];
+        }
+    }
+}
+
+void s16ToF32(const int16_t* src, size_t count, float scale, float* dst)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 k = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // duplicate each sample into both halves of a lane, then an
+        // arithmetic shift leaves it sign-extended
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), k));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), k));
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] = static_cast<float>(src[i]) * scale;
+}
+
+void s24ToF32(const uint8_t* src, size_t count, float scale, float* dst)
+{
+    size_t i = 0;
+#if defined(__SSSE3__)
+    // move each 3-byte sample into the top of a 32-bit lane; the value is
+    // then the sample times 256, which the scale undoes exactly
+    const __m128i spread = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m128 k = _mm_set1_ps(scale / 256.0f);
+    // each load reads 16 bytes but consumes 12
+    for (; (i + 4) * 3 + 4 <= count * 3; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_shuffle_epi8(v, spread)), k));
+    }
+#endif
+    for (; i < count; ++i) {
+        const uint8_t* b = src + i * 3;
+        int32_t v = static_cast<int32_t>((uint32_t(b[0]) << 8) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 24));
+        dst[i] = static_cast<float>(v) * (scale / 256.0f);
+    }
+}
+
+void s32ToF32(const int32_t* src, size_t count, float scale, float* dst)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 k = _mm_set1_ps(scale);
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), k));
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] = static_cast<float>(src[i]) * scale;
+}
+
+void f32ToF64(const float* src, size_t count, double* dst)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_loadu_ps(src + i);
+        _mm_storeu_pd(dst + i,     _mm_cvtps_pd(v));
+        _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] = src[i];
+}
+
+#if defined(__SSE2__)
+// Stores four real samples as {x * scale, 0} pairs.
+static inline void storeComplex4(double* dst, __m128 x, __m128d scale)
+{
+    const __m128d zero = _mm_setzero_pd();
+    __m128d lo = _mm_mul_pd(_mm_cvtps_pd(x), scale);
+    __m128d hi = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), scale);
+    _mm_storeu_pd(dst,     _mm_unpacklo_pd(lo, zero));
+    _mm_storeu_pd(dst + 2, _mm_unpackhi_pd(lo, zero));
+    _mm_storeu_pd(dst + 4, _mm_unpacklo_pd(hi, zero));
+    _mm_storeu_pd(dst + 6, _mm_unpackhi_pd(hi, zero));
+}
+#endif
+
+#if defined(__SSE2__)
+// Stores four complex pairs {re * scale, im * scale}.
+static inline void storeComplexPair4(double* dst, __m128 re, __m128 im, __m128d scale)
+{
+    __m128 lo = _mm_unpacklo_ps(re, im);    // r0 i0 r1 i1
+    __m128 hi = _mm_unpackhi_ps(re, im);    // r2 i2 r3 i3
+    _mm_storeu_pd(dst,     _mm_mul_pd(_mm_cvtps_pd(lo), scale));
+    _mm_storeu_pd(dst + 2, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(lo, lo)), scale));
+    _mm_storeu_pd(dst + 4, _mm_mul_pd(_mm_cvtps_pd(hi), scale));
+    _mm_storeu_pd(dst + 6, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(hi, hi)), scale));
+}
+#endif
+
+void packComplex(const float* src, size_t stride, size_t count, const float* window,
+                 double scale, std::complex<double>* dst)
+{
+    double* out = reinterpret_cast<double*>(dst);
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128d k = _mm_set1_pd(scale);
+    if (stride == 1) {
+        for (; i + 4 <= count; i += 4) {
+            __m128 x = _mm_loadu_ps(src + i);
+            if (window)
+                x = _mm_mul_ps(x, _mm_loadu_ps(window + i));
+            storeComplex4(out + 2 * i, x, k);
+        }
+    } else if (stride == 2) {
+        // the even lanes of two loads are the channel's next four samples;
+        // stopping one frame early keeps the second load inside the buffer
+        for (; i + 5 <= count; i += 4) {
+            __m128 a = _mm_loadu_ps(src + 2 * i);
+            __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+            __m128 x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            if (window)
+                x = _mm_mul_ps(x, _mm_loadu_ps(window + i));
+            storeComplex4(out + 2 * i, x, k);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        float x = src[i * stride];
+        if (window)
+            x *= window[i];
+        out[2 * i]     = static_cast<double>(x) * scale;
+        out[2 * i + 1] = 0.0;
+    }
+}
+
+void packComplexPair(const float* a, const float* b, size_t stride, size_t count,
+                     const float* window, double scale, std::complex<double>* dst)
+{
+    double* out = reinterpret_cast<double*>(dst);
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128d k = _mm_set1_pd(scale);
+    if (stride == 1) {
+        for (; i + 4 <= count; i += 4) {
+            __m128 x = _mm_loadu_ps(a + i);
+            __m128 y = _mm_loadu_ps(b + i);
+            if (window) {
+                __m128 w = _mm_loadu_ps(window + i);
+                x = _mm_mul_ps(x, w);
+                y = _mm_mul_ps(y, w);
+            }
+            storeComplexPair4(out + 2 * i, x, y, k);
+        }
+    } else if (stride == 2) {
+        for (; i + 5 <= count; i += 4) {
+            __m128 x = _mm_shuffle_ps(_mm_loadu_ps(a + 2 * i), _mm_loadu_ps(a + 2 * i + 4),
+                                      _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 y = _mm_shuffle_ps(_mm_loadu_ps(b + 2 * i), _mm_loadu_ps(b + 2 * i + 4),
+                                      _MM_SHUFFLE(2, 0, 2, 0));
+            if (window) {
+                __m128 w = _mm_loadu_ps(window + i);
+                x = _mm_mul_ps(x, w);
+                y = _mm_mul_ps(y, w);
+            }
+            storeComplexPair4(out + 2 * i, x, y, k);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        float x = a[i * stride], y = b[i * stride];
+        if (window) {
+            x *= window[i];
+            y *= window[i];
+        }
+        out[2 * i]     = static_cast<double>(x) * scale;
+        out[2 * i + 1] = static_cast<double>(y) * scale;
+    }
+}
+
+// Power and magnitude both come from |z|^2 * scale^2, so the vector and
+// scalar paths agree to the bit; dB is 10 log10 of the clamped power.
+template <typename T>
+static void complexToSpectrumT(const std::complex<double>* src, size_t count, double scale,
+                               SpectrumScale mode, double floorDb, T* dst)
+{
+    const double* z = reinterpret_cast<const double*>(src);
+    const double scale2 = scale * scale;
+    const double floorPower = std::pow(10.0, floorDb / 10);
+    auto finish = [&](double power) {
+        if (mode == SpectrumScale::Magnitude)
+            return std::sqrt(power);
+        if (mode == SpectrumScale::Power)
+            return power;
+        return 10 * std::log10(std::max(power, floorPower));
+    };
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128d vscale2 = _mm_set1_pd(scale2);
+    for (; i + 2 <= count; i += 2) {
+        __m128d a = _mm_loadu_pd(z + 2 * i);           // re0 im0
+        __m128d b = _mm_loadu_pd(z + 2 * i + 2);       // re1 im1
+        a = _mm_mul_pd(a, a);
+        b = _mm_mul_pd(b, b);
+        __m128d power = _mm_add_pd(_mm_unpacklo_pd(a, b), _mm_unpackhi_pd(a, b));
+        power = _mm_mul_pd(power, vscale2);
+        double lanes[2];
+        if (mode == SpectrumScale::Magnitude) {
+            _mm_storeu_pd(lanes, _mm_sqrt_pd(power));
+        } else {
+            _mm_storeu_pd(lanes, power);
+            if (mode == SpectrumScale::Decibels) {
+                lanes[0] = finish(lanes[0]);
+                lanes[1] = finish(lanes[1]);
+            }
+        }
+        dst[i]     = static_cast<T>(lanes[0]);
+        dst[i + 1] = static_cast<T>(lanes[1]);
+    }
+#endif
+    for (; i < count; ++i) {
+        const double re = z[2 * i], im = z[2 * i + 1];
+        dst[i] = static_cast<T>(finish((re * re + im * im) * scale2));
+    }
+}
+
+void complexToSpectrum(const std::complex<double>* src, size_t count, double scale,
+                       SpectrumScale mode, double floorDb, double* dst)
+{
+    complexToSpectrumT(src, count, scale, mode, floorDb, dst);
+}
+
+void complexToSpectrum(const std::complex<double>* src, size_t count, double scale,
+                       SpectrumScale mode, double floorDb, float* dst)
+{
+    complexToSpectrumT(src, count, scale, mode, floorDb, dst);
+}
+
+void complexMultiply(const std::complex<double>* a, const std::complex<double>* b, size_t count,
+                     std::complex<double>* dst)
+{
+    const double* x = reinterpret_cast<const double*>(a);
+    const double* y = reinterpret_cast<const double*>(b);
+    double* z = reinterpret_cast<double*>(dst);
+    size_t i = 0;
+#if defined(__SSE3__)
+    for (; i < count; ++i) {
+        // (xr yr - xi yi, xi yr + xr yi): addsub of (xr, xi) * yr and
+        // (xi, xr) * yi
+        __m128d xv = _mm_loadu_pd(x + 2 * i);
+        __m128d t  = _mm_mul_pd(xv, _mm_set1_pd(y[2 * i]));
+        __m128d u  = _mm_mul_pd(_mm_shuffle_pd(xv, xv, 1), _mm_set1_pd(y[2 * i + 1]));
+        _mm_storeu_pd(z + 2 * i, _mm_addsub_pd(t, u));
+    }
+#endif
+    for (; i < count; ++i) {
+        const double xr = x[2 * i], xi = x[2 * i + 1], yr = y[2 * i], yi = y[2 * i + 1];
+        z[2 * i]     = xr * yr - xi * yi;
+        z[2 * i + 1] = xi * yr + xr * yi;
+    }
+}
+
+void complexMultiplyAccumulate(const std::complex<double>* a, const std::complex<double>* b,
+                               size_t count, std::complex<double>* acc)
+{
+    const double* x = reinterpret_cast<const double*>(a);
+    const double* y = reinterpret_cast<const double*>(b);
+    double* z = reinterpret_cast<double*>(acc);
+    size_t i = 0;
+#if defined(__SSE3__)
+    for (; i < count; ++i) {
+        __m128d xv = _mm_loadu_pd(x + 2 * i);
+        __m128d t  = _mm_mul_pd(xv, _mm_set1_pd(y[2 * i]));
+        __m128d u  = _mm_mul_pd(_mm_shuffle_pd(xv, xv, 1), _mm_set1_pd(y[2 * i + 1]));
+        _mm_storeu_pd(z + 2 * i, _mm_add_pd(_mm_loadu_pd(z + 2 * i), _mm_addsub_pd(t, u)));
+    }
+#endif
+    for (; i < count; ++i) {
+        const double xr = x[2 * i], xi = x[2 * i + 1], yr = y[2 * i], yi = y[2 * i + 1];
+        z[2 * i]     += xr * yr - xi * yi;
+        z[2 * i + 1] += xi * yr + xr * yi;
+    }
+}
+
+float dotProduct(const float* a, const float* b, size_t count)
+{
+    size_t i = 0;
+    float sum = 0;
+#if defined(__SSE2__)
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(s0, s1));
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    float s[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (; i + 8 <= count; i += 8)
+        for (size_t l = 0; l < 8; ++l)
+            s[l] += a[i + l] * b[i + l];
+    sum = ((s[0] + s[4]) + (s[1] + s[5])) + ((s[2] + s[6]) + (s[3] + s[7]));
+#endif
+    for (; i < count; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
@@ -0,0 +1,70 @@
+#ifndef CONVERT_HPP
+#define CONVERT_HPP
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+// Sample format kernels. SSE2 versions are used when the compiler targets
+// SSE2 (always on x86_64), plus SSSE3 for packed 24-bit input and SSE3 for
+// complex products; other targets get the scalar loops. Vector and scalar
+// paths round identically, so results do not depend on where the tail of
+// a buffer falls.
+
+// Splits interleaved frames into per-channel buffers:
+// dst[c][i] = src[i * channels + c]. Mono and stereo have vector paths.
+void deinterleave(const float* src, size_t frames, uint32_t channels, float* const* dst);
+
+// Integer PCM to float, dst[i] = src[i] * scale; 1/32768, 1/8388608 and
+// 1/2147483648 map full scale to ±1.0. s24 samples are packed
+// little-endian, three bytes each.
+void s16ToF32(const int16_t* src, size_t count, float scale, float* dst);
+void s24ToF32(const uint8_t* src, size_t count, float scale, float* dst);
+void s32ToF32(const int32_t* src, size_t count, float scale, float* dst);
+
+// Widens float samples to double.
+void f32ToF64(const float* src, size_t count, double* dst);
+
+// Packs `count` real samples taken every `stride` floats from src into
+// complex FFT input, dst[i] = {src[i * stride] * window[i] * scale, 0}, in
+// one pass. Pass src + c and stride = channels to read channel c straight
+// out of interleaved frames; a null window is rectangular. Strides 1 and
+// 2 have vector paths.
+void packComplex(const float* src, size_t stride, size_t count, const float* window,
+                 double scale, std::complex<double>* dst);
+
+// Same for two real signals at once, a as the real and b as the imaginary
+// part, for transforming two real frames with one complex FFT.
+void packComplexPair(const float* a, const float* b, size_t stride, size_t count,
+                     const float* window, double scale, std::complex<double>* dst);
+
+// What complexToSpectrum() writes per bin, with m = scale * |z|: m itself,
+// m squared, or 20 log10(m) clamped below at a floor in dB.
+enum class SpectrumScale { Magnitude, Power, Decibels };
+
+// Turns FFT output into its magnitude, power or dB spectrum in one pass,
+// without hypot(): |z|^2 is formed two bins per vector, scaled, then
+// square-rooted or taken to dB. `scale` folds in normalization such as
+// 2 / sum(window).
+void complexToSpectrum(const std::complex<double>* src, size_t count, double scale,
+                       SpectrumScale mode, double floorDb, double* dst);
+void complexToSpectrum(const std::complex<double>* src, size_t count, double scale,
+                       SpectrumScale mode, double floorDb, float* dst);
+
+// Bin-by-bin product of two spectra, dst[i] = a[i] * b[i]; dst may alias
+// either input. Avoids std::complex's NaN-checking multiply and does one
+// bin per SSE3 vector.
+void complexMultiply(const std::complex<double>* a, const std::complex<double>* b, size_t count,
+                     std::complex<double>* dst);
+
+// acc[i] += a[i] * b[i], the same product summed into place.
+void complexMultiplyAccumulate(const std::complex<double>* a, const std::complex<double>* b,
+                               size_t count, std::complex<double>* acc);
+
+// Sum of a[i] * b[i] in one fixed order on every path: whole groups of
+// eight products go to eight running sums s[i % 8], which are added as
+// ((s0 + s4) + (s1 + s5)) + ((s2 + s6) + (s3 + s7)); the tail follows in
+// index order.
+float dotProduct(const float* a, const float* b, size_t count);
+
+#endif
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "convert.hpp"
+#include "convolve.hpp"
+#include "parallel.hpp"
+
+// Largest FFT chooseFftSize() considers; past it the per-sample cost is
+// flat and the latency only grows.
+static const size_t CONVOLVE_MAX_FFT = size_t(1) << 22;
+
+size_t FftConvolver::chooseFftSize(size_t taps)
+{
+    // an FFT and an inverse of N log2 N each, plus the product, buy
+    // N - M + 1 output samples
+    size_t best = 0;
+    double bestCost = 0;
+    for (size_t n = std::max<size_t>(2, nextPowerOfTwo(2 * taps - 1)); ; n <<= 1) {
+        const double cost = n * (2 * std::log2(static_cast<double>(n)) + 1) / (n - taps + 1);
+        if (best == 0 || cost < bestCost) {
+            best = n;
+            bestCost = cost;
+        }
+        if (n >= CONVOLVE_MAX_FFT)
+            break;
+    }
+    return best;
+}
+
+static size_t checkedFftSize(size_t taps, size_t fftSize)
+{
+    if (taps == 0)
+        throw std::runtime_error("convolve: the filter has no taps");
+    if (fftSize == 0)
+        return FftConvolver::chooseFftSize(taps);
+    if (!isPowerOfTwo(fftSize) || fftSize < 2 * taps - 2)
+        throw std::runtime_error("convolve: FFT size " + std::to_string(fftSize) +
+                                 " does not fit a filter of " + std::to_string(taps) + " taps");
+    return fftSize;
+}
+
+FftConvolver::FftConvolver(const std::vector<float>& filter, ConvolutionMode mode, size_t fftSize)
+    : mode_(mode), taps_(filter.size()), plan_(checkedFftSize(filter.size(), fftSize)),
+      block_(plan_.size() - taps_ + 1), spectrum_(plan_.size()), work_(plan_.size())
+{
+    // 1/N of the unscaled inverse rides along with every product
+    const size_t n = plan_.size();
+    packComplex(filter.data(), 1, taps_, nullptr, 1.0 / n, spectrum_.data());
+    std::fill(spectrum_.begin() + taps_, spectrum_.end(), std::complex<double>(0));
+    plan_.forward(spectrum_.data());
+
+    if (mode_ == ConvolutionMode::OverlapSave)
+        input_.assign(taps_ - 1, 0.0f);
+    else
+        tail_.assign(taps_ - 1, 0.0f);
+}
+
+void FftConvolver::runBlocks(size_t blocks, std::vector<float>& out)
+{
+    const size_t n = plan_.size(), overlap = taps_ - 1;
+    const float* a = input_.data();
+    const float* b = a + block_;
+    std::complex<double>* w = work_.data();
+
+    // overlap-save windows span the whole transform, history included;
+    // overlap-add blocks are zero-padded
+    const size_t span = mode_ == ConvolutionMode::OverlapSave ? n : block_;
+    if (blocks == 2)
+        packComplexPair(a, b, 1, span, nullptr, 1.0, w);
+    else
+        packComplex(a, 1, span, nullptr, 1.0, w);
+    std::fill(work_.begin() + span, work_.end(), std::complex<double>(0));
+
+    plan_.forward(w);
+    complexMultiply(w, spectrum_.data(), n, w);
+    plan_.inverse(w);
+
+    const double* y = reinterpret_cast<const double*>(w);
+    for (size_t j = 0; j < blocks; ++j) {
+        // block j's samples are the real (j = 0) or imaginary (j = 1) parts
+        const double* part = y + j;
+        if (mode_ == ConvolutionMode::OverlapSave) {
+            for (size_t i = overlap; i < n; ++i)
+                out.push_back(static_cast<float>(part[2 * i]));
+        } else {
+            for (size_t i = 0; i < block_; ++i)
+                out.push_back(static_cast<float>(part[2 * i] + (i < overlap ? tail_[i] : 0.0)));
+            for (size_t i = 0; i < overlap; ++i)
+                tail_[i] = static_cast<float>(part[2 * (block_ + i)]);
+        }
+    }
+    input_.erase(input_.begin(), input_.begin() + blocks * block_);
+}
+
+void FftConvolver::process(const float* src, size_t count, size_t stride, std::vector<float>& out)
+{
+    const size_t history = mode_ == ConvolutionMode::OverlapSave ? taps_ - 1 : 0;
+    for (size_t i = 0; i < count; ++i)
+        input_.push_back(src[i * stride]);
+    // blocks always pair up from the start of the stream, so the output
+    // does not depend on how the input was split across calls
+    while (input_.size() - history >= 2 * block_)
+        runBlocks(2, out);
+}
+
+void FftConvolver::finish(std::vector<float>& out)
+{
+    const size_t history = mode_ == ConvolutionMode::OverlapSave ? taps_ - 1 : 0;
+    const size_t remaining = input_.size() - history + taps_ - 1;
+    const size_t blocks = (remaining + block_ - 1) / block_;
+    input_.resize(history + blocks * block_, 0.0f);
+
+    const size_t before = out.size();
+    for (size_t b = 0; b < blocks; b += 2)
+        runBlocks(std::min<size_t>(2, blocks - b), out);
+    out.resize(before + remaining);
+
+    input_.assign(history, 0.0f);
+    std::fill(tail_.begin(), tail_.end(), 0.0f);
+}
+
+std::vector<float> fftConvolve(const float* x, size_t n, const std::vector<float>& filter,
+                               ConvolutionMode mode)
+{
+    FftConvolver conv(filter, mode);
+    std::vector<float> out;
+    out.reserve(n + filter.size() - 1);
+    conv.process(x, n, 1, out);
+    conv.finish(out);
+    return out;
+}
+
+static size_t checkedBlockSize(size_t taps, size_t blockSize)
+{
+    if (taps == 0)
+        throw std::runtime_error("convolve: the filter has no taps");
+    if (blockSize < 2 || !isPowerOfTwo(blockSize))
+        throw std::runtime_error("convolve: block size " + std::to_string(blockSize) +
+                                 " is not a power of two >= 2");
+    return blockSize;
+}
+
+PartitionedConvolver::PartitionedConvolver(const std::vector<float>& filter, size_t blockSize)
+    : taps_(filter.size()), block_(checkedBlockSize(filter.size(), blockSize)),
+      partitions_((taps_ + block_ - 1) / block_), plan_(2 * block_)
+{
+    // each partition zero-padded to 2B, with the inverse's 1/2B folded in
+    const size_t bins = plan_.bins();
+    const double scale = 1.0 / plan_.size();
+    filter_.assign(partitions_ * bins, std::complex<double>(0));
+    for (size_t p = 0; p < partitions_; ++p) {
+        std::complex<double>* spectrum = filter_.data() + p * bins;
+        double* x = reinterpret_cast<double*>(spectrum);
+        const size_t first = p * block_, n = std::min(block_, taps_ - first);
+        for (size_t i = 0; i < n; ++i)
+            x[i] = filter[first + i] * scale;
+        plan_.forward(spectrum);
+    }
+    delay_.assign(partitions_ * bins, std::complex<double>(0));
+    work_.resize(bins);
+    history_.assign(2 * block_, 0.0f);
+    blockOut_.resize(block_);
+}
+
+void PartitionedConvolver::processBlock(const float* in, float* out)
+{
+    const size_t bins = plan_.bins();
+    std::copy(history_.begin() + block_, history_.end(), history_.begin());
+    std::copy(in, in + block_, history_.begin() + block_);
+
+    // the newest spectrum replaces the oldest one in the ring
+    newest_ = newest_ + 1 == partitions_ ? 0 : newest_ + 1;
+    std::complex<double>* spectrum = delay_.data() + newest_ * bins;
+    f32ToF64(history_.data(), 2 * block_, reinterpret_cast<double*>(spectrum));
+    plan_.forward(spectrum);
+
+    // partition p meets the input from p blocks ago
+    std::fill(work_.begin(), work_.end(), std::complex<double>(0));
+    size_t slot = newest_;
+    for (size_t p = 0; p < partitions_; ++p) {
+        complexMultiplyAccumulate(delay_.data() + slot * bins, filter_.data() + p * bins, bins,
+                                  work_.data());
+        slot = slot == 0 ? partitions_ - 1 : slot - 1;
+    }
+    plan_.inverse(work_.data());
+
+    // the first half wrapped around; the second is this block's output
+    const double* y = reinterpret_cast<const double*>(work_.data()) + block_;
+    for (size_t i = 0; i < block_; ++i)
+        out[i] = static_cast<float>(y[i]);
+}
+
+void PartitionedConvolver::process(const float* src, size_t count, size_t stride,
+                                   std::vector<float>& out)
+{
+    for (size_t i = 0; i < count; ++i) {
+        pending_.push_back(src[i * stride]);
+        if (pending_.size() == block_) {
+            processBlock(pending_.data(), blockOut_.data());
+            out.insert(out.end(), blockOut_.begin(), blockOut_.end());
+            pending_.clear();
+        }
+    }
+}
+
+void PartitionedConvolver::finish(std::vector<float>& out)
+{
+    // silence pushes the pending input and then the filter's tail out
+    const size_t remaining = pending_.size() + taps_ - 1;
+    const size_t before = out.size();
+    while (out.size() - before < remaining) {
+        pending_.resize(block_, 0.0f);
+        processBlock(pending_.data(), blockOut_.data());
+        out.insert(out.end(), blockOut_.begin(), blockOut_.end());
+        pending_.clear();
+    }
+    out.resize(before + remaining);
+    reset();
+}
+
+void PartitionedConvolver::reset()
+{
+    std::fill(delay_.begin(), delay_.end(), std::complex<double>(0));
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    pending_.clear();
+    newest_ = 0;
+}
+
+// Runs a copy of `prototype` over every channel; the copies share nothing,
+// so channels go in parallel.
+template<class Convolver>
+static void filterChannelsWith(AudioData& data, const Convolver& prototype, unsigned threads)
+{
+    const size_t frames = data.frames();
+    const bool planar = data.layout == SampleLayout::Planar;
+    parallelFor(data.channels, [&](size_t c) {
+        float* samples = planar ? data.plane(c) : data.samples.data() + c;
+        const size_t stride = planar ? 1 : data.channels;
+        Convolver conv(prototype);
+        std::vector<float> y;
+        y.reserve(frames + conv.taps() - 1);
+        conv.process(samples, frames, stride, y);
+        conv.finish(y);
+        for (size_t i = 0; i < frames; ++i)
+            samples[i * stride] = y[i];
+    }, threads);
+}
+
+void filterChannels(AudioData& data, const std::vector<float>& filter, ConvolutionMode mode,
+                    unsigned threads)
+{
+    filterChannelsWith(data, FftConvolver(filter, mode), threads);
+}
+
+void filterChannelsPartitioned(AudioData& data, const std::vector<float>& filter,
+                               size_t blockSize, unsigned threads)
+{
+    filterChannelsWith(data, PartitionedConvolver(filter, blockSize), threads);
+}
+
+std::vector<float> loadFilterTaps(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("convolve: cannot open " + path);
+    std::vector<float> taps;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string field;
+        while (fields >> field) {
+            size_t used = 0;
+            float v = 0;
+            try {
+                v = std::stof(field, &used);
+            } catch (const std::exception&) {
+                used = 0;
+            }
+            if (used != field.size())
+                throw std::runtime_error("convolve: bad tap '" + field + "' in " + path);
+            taps.push_back(v);
+        }
+    }
+    if (taps.empty())
+        throw std::runtime_error("convolve: no taps in " + path);
+    return taps;
+}
@@ -0,0 +1,128 @@
+#ifndef CONVOLVE_HPP
+#define CONVOLVE_HPP
+
+#include <complex>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "audio.hpp"
+#include "fft.hpp"
+
+// Overlap-add transforms zero-padded blocks and adds the overlapping tails
+// of their results; overlap-save transforms blocks that carry the previous
+// M - 1 inputs along and discards the wrapped-around M - 1 outputs. Both
+// give the same linear convolution.
+enum class ConvolutionMode { OverlapAdd, OverlapSave };
+
+// Streaming FFT convolution with a fixed FIR filter of M taps. Input is
+// cut into blocks of blockSize() = fftSize() - M + 1 samples; each block
+// costs one FFT, a bin-by-bin product with the filter's spectrum
+// (computed once) and one inverse FFT, so the work per sample grows with
+// log(fftSize) instead of M. Two blocks share each transform, one as the
+// real and one as the imaginary part: the filter is real, so the halves
+// of the product never mix.
+class FftConvolver {
+public:
+    // fftSize 0 picks the cheapest size for the filter; an explicit size
+    // must be a power of two of at least 2M - 2.
+    explicit FftConvolver(const std::vector<float>& filter,
+                          ConvolutionMode mode = ConvolutionMode::OverlapSave,
+                          size_t fftSize = 0);
+
+    // Power of two minimizing the FFT work per output sample for M taps.
+    static size_t chooseFftSize(size_t taps);
+
+    size_t fftSize() const { return plan_.size(); }
+    size_t blockSize() const { return block_; }
+    size_t taps() const { return taps_; }
+
+    // Filters `count` samples taken every `stride` floats from src and
+    // appends every output sample that is complete to `out`, in order.
+    // Output lags input by up to two blocks.
+    void process(const float* src, size_t count, size_t stride, std::vector<float>& out);
+
+    // Appends the rest of the output, up to the end of the filter's tail,
+    // so the whole stream yields N + M - 1 samples for N in. The convolver
+    // then starts over from silence.
+    void finish(std::vector<float>& out);
+
+private:
+    // Convolves one or two blocks at the front of pending input and
+    // appends their output.
+    void runBlocks(size_t blocks, std::vector<float>& out);
+
+    ConvolutionMode mode_;
+    size_t taps_;
+    FftPlan plan_;
+    size_t block_;
+    std::vector<std::complex<double>> spectrum_;    // filter FFT scaled by 1/N
+    std::vector<std::complex<double>> work_;
+    std::vector<float> input_;      // overlap-save: M - 1 past inputs, then pending
+    std::vector<float> tail_;       // overlap-add: M - 1 outputs still being summed
+};
+
+// Uniformly partitioned overlap-save convolution for long filters at low
+// latency. The filter is cut into P partitions of blockSize() = B taps,
+// each transformed once at 2B. Every block of B inputs is transformed
+// with the block before it, its spectrum pushed onto a frequency-domain
+// delay line of the last P block spectra, and the output block is the
+// inverse of sum(delay[p] * partition[p]). A block therefore costs one
+// real FFT and one inverse of 2B plus P bin-by-bin products, the same for
+// every block: output trails input by B samples whatever the filter
+// length, and the time per block is bounded.
+class PartitionedConvolver {
+public:
+    // blockSize must be a power of two of at least 2.
+    explicit PartitionedConvolver(const std::vector<float>& filter, size_t blockSize = 64);
+
+    size_t blockSize() const { return block_; }
+    size_t partitions() const { return partitions_; }
+    size_t taps() const { return taps_; }
+
+    // Filters exactly blockSize() samples: out receives the output for the
+    // same span of time as `in`. This is the call for a live audio
+    // callback; it never allocates. in and out may be the same buffer.
+    void processBlock(const float* in, float* out);
+
+    // Same contract as FftConvolver::process(): output appended in order,
+    // lagging input by less than one block.
+    void process(const float* src, size_t count, size_t stride, std::vector<float>& out);
+
+    // Same contract as FftConvolver::finish().
+    void finish(std::vector<float>& out);
+
+    // Back to silence: clears the delay line and any pending input.
+    void reset();
+
+private:
+    size_t taps_;
+    size_t block_;
+    size_t partitions_;
+    RealFftPlan plan_;
+    std::vector<std::complex<double>> filter_;      // P partition spectra scaled by 1/2B
+    std::vector<std::complex<double>> delay_;       // ring of the last P input spectra
+    size_t newest_ = 0;                             // delay_ slot of the latest block
+    std::vector<std::complex<double>> work_;
+    std::vector<float> history_;    // previous block, then the current one
+    std::vector<float> pending_;    // process(): input short of a whole block
+    std::vector<float> blockOut_;   // process()/finish(): one block of output
+};
+
+// Full linear convolution of x with the filter, n + M - 1 samples.
+std::vector<float> fftConvolve(const float* x, size_t n, const std::vector<float>& filter,
+                               ConvolutionMode mode = ConvolutionMode::OverlapSave);
+
+// Filters every channel of `data` in place, channels in parallel on up to
+// `threads` threads (0 = workerCount()). The filter is treated as causal:
+// the first frames() samples of each convolution are kept.
+void filterChannels(AudioData& data, const std::vector<float>& filter,
+                    ConvolutionMode mode = ConvolutionMode::OverlapSave, unsigned threads = 0);
+// The same through PartitionedConvolver with blocks of blockSize.
+void filterChannelsPartitioned(AudioData& data, const std::vector<float>& filter,
+                               size_t blockSize, unsigned threads = 0);
+
+// Reads FIR taps from a text file, whitespace or newline separated; '#'
+// starts a comment.
+std::vector<float> loadFilterTaps(const std::string& path);
+
+#endif
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "correlate.hpp"
+#include "fft.hpp"
+
+// PHAT leaves bins this far below the strongest one at zero instead of
+// blowing rounding noise up to full height.
+static const double PHAT_FLOOR = 1e-12;
+
+double Correlation::peakLag() const
+{
+    if (values.empty())
+        throw std::runtime_error("correlate: no values");
+    const size_t i = std::max_element(values.begin(), values.end()) - values.begin();
+    double offset = 0;
+    if (i > 0 && i + 1 < values.size()) {
+        const double a = values[i - 1], b = values[i], c = values[i + 1];
+        const double denom = a - 2 * b + c;
+        if (denom < 0)
+            offset = 0.5 * (a - c) / denom;
+    }
+    return firstLag + static_cast<double>(i) + offset;
+}
+
+// The view's samples, zero-padded to plan.size() and transformed.
+static std::vector<std::complex<double>> transform(const AudioView& v, const RealFftPlan& plan)
+{
+    std::vector<std::complex<double>> spectrum(plan.bins());
+    double* x = reinterpret_cast<double*>(spectrum.data());
+    for (size_t i = 0; i < v.frames; ++i)
+        x[i] = v[i];
+    plan.forward(spectrum.data());
+    return spectrum;
+}
+
+// Inverts a product spectrum and keeps lags first..last, negative ones
+// read from the end of the circular result.
+static Correlation lags(std::vector<std::complex<double>>& spectrum, const RealFftPlan& plan,
+                        long long first, long long last)
+{
+    plan.inverse(spectrum.data());
+    const double* y = reinterpret_cast<const double*>(spectrum.data());
+    const long long n = static_cast<long long>(plan.size());
+    const double scale = 1.0 / n;
+
+    Correlation r;
+    r.firstLag = first;
+    r.values.resize(last - first + 1);
+    for (long long k = first; k <= last; ++k)
+        r.values[k - first] = y[k < 0 ? k + n : k] * scale;
+    return r;
+}
+
+Correlation crossCorrelate(const AudioView& a, const AudioView& b, const CorrelationConfig& config)
+{
+    if (a.frames == 0 || b.frames == 0)
+        throw std::runtime_error("correlate: empty signal");
+
+    // lag k survives the wrap-around as long as k + N and k - N both fall
+    // outside the overlap, so a lag limit shortens the padding
+    size_t below = b.frames - 1, above = a.frames - 1;
+    size_t length = a.frames + b.frames - 1;
+    if (config.maxLag > 0) {
+        below = std::min(below, config.maxLag);
+        above = std::min(above, config.maxLag);
+        length = std::min(length, std::max(a.frames, b.frames) + config.maxLag);
+    }
+    const RealFftPlan plan(std::max<size_t>(2, nextPowerOfTwo(length)));
+
+    std::vector<std::complex<double>> spectrum = transform(a, plan);
+    {
+        const std::vector<std::complex<double>> other = transform(b, plan);
+        double* x = reinterpret_cast<double*>(spectrum.data());
+        const double* y = reinterpret_cast<const double*>(other.data());
+        // A * conj(B), on raw doubles like the other spectrum kernels
+        for (size_t k = 0; k < spectrum.size(); ++k) {
+            const double ar = x[2 * k], ai = x[2 * k + 1], br = y[2 * k], bi = y[2 * k + 1];
+            x[2 * k]     = ar * br + ai * bi;
+            x[2 * k + 1] = ai * br - ar * bi;
+        }
+    }
+
+    if (config.weighting == CorrelationWeighting::Phat) {
+        double peak = 0;
+        for (const std::complex<double>& z : spectrum)
+            peak = std::max(peak, std::abs(z));
+        for (std::complex<double>& z : spectrum) {
+            const double m = std::abs(z);
+            z = m > PHAT_FLOOR * peak ? z / m : std::complex<double>(0);
+        }
+    }
+    return lags(spectrum, plan, -static_cast<long long>(below), static_cast<long long>(above));
+}
+
+Correlation autocorrelate(const AudioView& x, size_t maxLag)
+{
+    if (x.frames == 0)
+        throw std::runtime_error("correlate: empty signal");
+    const size_t last = maxLag > 0 ? std::min(maxLag, x.frames - 1) : x.frames - 1;
+    const RealFftPlan plan(std::max<size_t>(2, nextPowerOfTwo(x.frames + last)));
+
+    std::vector<std::complex<double>> spectrum = transform(x, plan);
+    for (std::complex<double>& z : spectrum)
+        z = std::norm(z);
+    return lags(spectrum, plan, 0, static_cast<long long>(last));
+}
@@ -0,0 +1,43 @@
+#ifndef CORRELATE_HPP
+#define CORRELATE_HPP
+
+#include <cstddef>
+#include <vector>
+#include "audio.hpp"
+
+// GCC-PHAT divides every bin of the cross spectrum by its magnitude
+// before the inverse, keeping only phase. The peak turns into a spike
+// that reverberation and strong low frequencies cannot smear, which is
+// what delay estimation wants; the values are no longer a plain sum.
+enum class CorrelationWeighting { None, Phat };
+
+struct CorrelationConfig {
+    CorrelationWeighting weighting = CorrelationWeighting::None;
+    size_t maxLag = 0;              // largest |lag| kept; 0 keeps every lag
+};
+
+// Correlation values over a run of consecutive lags.
+struct Correlation {
+    std::vector<double> values;     // values[i] is lag firstLag + i
+    long long firstLag = 0;
+
+    double at(long long lag) const { return values[lag - firstLag]; }
+    // Lag of the highest value, refined to a fraction of a sample by a
+    // parabola through it and its two neighbours.
+    double peakLag() const;
+};
+
+// r[k] = sum over n of a[n + k] * b[n], for every k where the signals
+// overlap (-(b.frames - 1) .. a.frames - 1, within maxLag). A peak at
+// k > 0 means a trails b by k samples. Both signals go through one real
+// FFT each, zero-padded so the circular product cannot wrap into the
+// kept lags: O(N log N) where the sum is O(N^2).
+Correlation crossCorrelate(const AudioView& a, const AudioView& b,
+                           const CorrelationConfig& config = CorrelationConfig());
+
+// r[k] = sum over n of x[n + k] * x[n] for lags 0 .. min(maxLag,
+// frames - 1), maxLag 0 meaning all; negative lags mirror these. One real
+// FFT and its inverse.
+Correlation autocorrelate(const AudioView& x, size_t maxLag = 0);
+
+#endif
@@ -0,0 +1,2 @@
+#define DR_FLAC_IMPLEMENTATION
+#include "dr_flac.h"
@@ -2354,7 +2354,7 @@ DRWAV_PRIVATE drwav_bool32 drwav_init__internal(drwav* pWav, drwav_chunk_proc on
     going to have to calculate the size by reading and discarding bytes, and then seeking back. We
     cannot do this in sequential mode. We just assume that the rest of the file is audio data.
     */
-    if (dataChunkSize == 0xFFFFFFFF && (pWav->container == drwav_container_riff || pWav->container == drwav_container_rifx) && pWav->isSequentialWrite == DRWAV_FALSE) {
+    if (dataChunkSize == 0xFFFFFFFF && (pWav->container == drwav_container_riff || pWav->container == drwav_container_rifx) && pWav->isSequentialWrite == DRWAV_FALSE && !sequential) {
         dataChunkSize = 0;
 
         for (;;) {
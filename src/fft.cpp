@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include "fft.hpp"
+
+#if defined(__SSE3__)
+#include <pmmintrin.h>
+#endif
+
+static const double PI = std::acos(-1.0);
+
+void fft(std::vector<std::complex<double>>& xs, bool invert)
+{
+    size_t N = xs.size();
+
+    if (N == 1)
+        return;
+
+    std::vector<std::complex<double>> es(N/2), os(N/2);
+
+    for (size_t i = 0; i < N/2; ++i)
+        es[i] = xs[2*i];
+
+    for (size_t i = 0; i < N/2; ++i)
+        os[i] = xs[2*i + 1];
+
+    fft(es, invert);
+    fft(os, invert);
+
+    auto signal = (invert ? 1 : -1);
+    auto theta = 2 * signal * PI / N;
+    std::complex<double> S { 1 }, S1 { std::cos(theta), std::sin(theta) };
+
+    for (size_t i = 0; i < N/2; ++i)
+    {
+        xs[i] = (es[i] + S * os[i]);
+        xs[i] /= (invert ? 2 : 1);
+
+        xs[i + N/2] = (es[i] - S * os[i]);
+        xs[i + N/2] /= (invert ? 2 : 1);
+
+        S *= S1;
+    }
+}
+
+bool isPowerOfTwo(size_t n)
+{
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+size_t nextPowerOfTwo(size_t n)
+{
+    size_t p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+FftPlan::FftPlan(size_t n) : n_(n)
+{
+    if (!isPowerOfTwo(n))
+        throw std::runtime_error("fft: plan size " + std::to_string(n) + " is not a power of two");
+
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            swaps_.push_back(i);
+            swaps_.push_back(j);
+        }
+    }
+
+    // each stage's twiddles stored contiguously: stage `half` uses
+    // exp(-πij/half), j < half, at offset half - 1
+    twiddles_.resize(n > 1 ? n - 1 : 0);
+    for (size_t half = 1; half < n; half <<= 1)
+        for (size_t j = 0; j < half; ++j)
+            twiddles_[half - 1 + j] = std::polar(1.0, -PI * j / half);
+}
+
+void FftPlan::forward(std::complex<double>* xs) const
+{
+    for (size_t s = 0; s < swaps_.size(); s += 2)
+        std::swap(xs[swaps_[s]], xs[swaps_[s + 1]]);
+
+    // butterflies on raw doubles: std::complex multiplication goes through
+    // the NaN-checking library call unless -ffast-math is on
+    double* x = reinterpret_cast<double*>(xs);
+    const double* w = reinterpret_cast<const double*>(twiddles_.data());
+    for (size_t half = 1; half < n_; half <<= 1) {
+        const double* stage = w + 2 * (half - 1);
+        for (size_t block = 0; block < n_; block += 2 * half) {
+            for (size_t j = 0; j < half; ++j) {
+                double* a = x + 2 * (block + j);
+                double* b = a + 2 * half;
+#if defined(__SSE3__)
+                // one complex number per register; addsub forms
+                // (br wr - bi wi, bi wr + br wi) in one step
+                __m128d bv = _mm_loadu_pd(b);
+                __m128d t  = _mm_mul_pd(bv, _mm_set1_pd(stage[2 * j]));
+                __m128d u  = _mm_mul_pd(_mm_shuffle_pd(bv, bv, 1), _mm_set1_pd(stage[2 * j + 1]));
+                __m128d bw = _mm_addsub_pd(t, u);
+                __m128d av = _mm_loadu_pd(a);
+                _mm_storeu_pd(b, _mm_sub_pd(av, bw));
+                _mm_storeu_pd(a, _mm_add_pd(av, bw));
+#else
+                const double wr = stage[2 * j], wi = stage[2 * j + 1];
+                const double br = b[0] * wr - b[1] * wi;
+                const double bi = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - br;
+                b[1] = a[1] - bi;
+                a[0] += br;
+                a[1] += bi;
+#endif
+            }
+        }
+    }
+}
+
+// The inverse is the forward transform with real and imaginary parts
+// swapped on the way in and out: swap(x) = i conj(x), and
+// conj(F(conj(x))) is the unscaled inverse.
+static void swapParts(std::complex<double>* xs, size_t n)
+{
+    double* x = reinterpret_cast<double*>(xs);
+    for (size_t i = 0; i < n; ++i)
+        std::swap(x[2 * i], x[2 * i + 1]);
+}
+
+void FftPlan::inverse(std::complex<double>* xs) const
+{
+    swapParts(xs, n_);
+    forward(xs);
+    swapParts(xs, n_);
+}
+
+// Plain product, without std::complex's NaN-checking library call.
+static inline std::complex<double> multiply(std::complex<double> a, std::complex<double> b)
+{
+    return std::complex<double>(a.real() * b.real() - a.imag() * b.imag(),
+                                a.real() * b.imag() + a.imag() * b.real());
+}
+
+RealFftPlan::RealFftPlan(size_t n) : n_(n), half_(n / 2)
+{
+    if (n < 2 || !isPowerOfTwo(n))
+        throw std::runtime_error("fft: real plan size " + std::to_string(n) + " is not a power of two >= 2");
+    twiddles_.resize(n / 4 + 1);
+    for (size_t k = 0; k < twiddles_.size(); ++k)
+        twiddles_[k] = std::polar(1.0, -2 * PI * k / n);
+}
+
+// With z the packed samples and Z = FFT(z) of size h = n/2, the even and
+// odd samples' spectra are E = (Z[k] + conj Z[h-k]) / 2 and
+// O = (Z[k] - conj Z[h-k]) / 2i, and X[k] = E + W^k O. Bin h - k comes
+// out of the same pair as conj(E - W^k O), so each pair is done at once
+// and the transform stays in place.
+void RealFftPlan::forward(std::complex<double>* xs) const
+{
+    const size_t h = n_ / 2;
+    half_.forward(xs);
+
+    const std::complex<double> z0 = xs[0];
+    xs[0] = z0.real() + z0.imag();
+    xs[h] = z0.real() - z0.imag();
+    for (size_t k = 1; 2 * k <= h; ++k) {
+        const std::complex<double> a = xs[k], b = std::conj(xs[h - k]);
+        const std::complex<double> e = 0.5 * (a + b);
+        const std::complex<double> d = a - b;
+        const std::complex<double> o(0.5 * d.imag(), -0.5 * d.real());
+        const std::complex<double> wo = multiply(twiddles_[k], o);
+        xs[k] = e + wo;
+        xs[h - k] = std::conj(e - wo);
+    }
+}
+
+// forward() run backwards: 2E = X[k] + conj X[h-k], 2O = (X[k] -
+// conj X[h-k]) conj(W^k), Z[k] = 2(E + iO); the factor 2 and the
+// unscaled inverse of size h make the result n times the samples.
+void RealFftPlan::inverse(std::complex<double>* xs) const
+{
+    const size_t h = n_ / 2;
+    for (size_t k = 0; 2 * k <= h; ++k) {
+        const std::complex<double> a = xs[k], b = std::conj(xs[h - k]);
+        const std::complex<double> e = a + b;
+        const std::complex<double> o = multiply(a - b, std::conj(twiddles_[k]));
+        const std::complex<double> io(-o.imag(), o.real());
+        xs[k] = e + io;
+        if (k > 0)
+            xs[h - k] = std::conj(e) + std::complex<double>(o.imag(), o.real());
+    }
+    half_.inverse(xs);
+}
@@ -0,0 +1,60 @@
+#ifndef FFT_HPP
+#define FFT_HPP
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// In-place recursive radix-2 FFT; `invert` gives the inverse, scaled by 1/N.
+void fft(std::vector<std::complex<double>>& xs, bool invert = false);
+
+bool isPowerOfTwo(size_t n);
+// Smallest power of two >= n (1 for 0).
+size_t nextPowerOfTwo(size_t n);
+
+// Iterative radix-2 FFT of one power-of-two size. The bit-reversal order
+// and the twiddles are computed once, exactly rather than by repeated
+// multiplication, and every transform then runs in place without
+// allocating. A plan is immutable, so threads can share one.
+class FftPlan {
+public:
+    explicit FftPlan(size_t n);
+
+    size_t size() const { return n_; }
+    // Forward transform of size() values, in place.
+    void forward(std::complex<double>* xs) const;
+    // Inverse transform in place, NOT scaled by 1/size(); callers fold the
+    // scale into something they multiply anyway.
+    void inverse(std::complex<double>* xs) const;
+
+private:
+    size_t n_;
+    std::vector<size_t> swaps_;                     // bit-reversal pairs (i, j), i < j
+    std::vector<std::complex<double>> twiddles_;    // per stage, n - 1 in all
+};
+
+// FFT of n real samples through a complex FftPlan of n / 2: the samples
+// are read as n / 2 complex values (even ones real, odd ones imaginary),
+// transformed, and the two interleaved half-spectra pulled apart. Only
+// bins 0..n/2 are kept; the rest mirror them. Half the work and half the
+// bins of a complex transform of n.
+class RealFftPlan {
+public:
+    explicit RealFftPlan(size_t n);
+
+    size_t size() const { return n_; }
+    size_t bins() const { return n_ / 2 + 1; }
+    // In place: xs holds size() real samples as size()/2 complex values on
+    // entry, with room for bins() values, and bins 0..size()/2 on return.
+    void forward(std::complex<double>* xs) const;
+    // Inverse of forward(), in place and NOT scaled: bins() values in,
+    // size() real samples times size() out, packed the same way.
+    void inverse(std::complex<double>* xs) const;
+
+private:
+    size_t n_;
+    FftPlan half_;
+    std::vector<std::complex<double>> twiddles_;    // exp(-2πik/n), k <= n/4
+};
+
+#endif
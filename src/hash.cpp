@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "hash.hpp"
+
+static const uint64_t P1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t P3 = 0x165667B19E3779F9ULL;
+static const uint64_t P4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t P5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+static inline uint64_t read64(const unsigned char* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t round64(uint64_t acc, uint64_t input)
+{
+    acc += input * P2;
+    acc = rotl(acc, 31);
+    return acc * P1;
+}
+
+static inline uint64_t merge64(uint64_t acc, uint64_t lane)
+{
+    acc ^= round64(0, lane);
+    return acc * P1 + P4;
+}
+
+// Streaming state so files can be hashed block by block.
+struct Hasher {
+    uint64_t v[4];
+    uint64_t seed;
+    uint64_t total = 0;
+    unsigned char tail[32];
+    size_t tailSize = 0;
+
+    explicit Hasher(uint64_t s) : seed(s)
+    {
+        v[0] = s + P1 + P2;
+        v[1] = s + P2;
+        v[2] = s;
+        v[3] = s - P1;
+    }
+
+    void stripe(const unsigned char* p)
+    {
+        v[0] = round64(v[0], read64(p));
+        v[1] = round64(v[1], read64(p + 8));
+        v[2] = round64(v[2], read64(p + 16));
+        v[3] = round64(v[3], read64(p + 24));
+    }
+
+    void update(const unsigned char* p, size_t n)
+    {
+        total += n;
+        if (tailSize) {
+            size_t take = std::min(n, 32 - tailSize);
+            std::memcpy(tail + tailSize, p, take);
+            tailSize += take;
+            p += take;
+            n -= take;
+            if (tailSize < 32)
+                return;
+            stripe(tail);
+            tailSize = 0;
+        }
+        for (; n >= 32; p += 32, n -= 32)
+            stripe(p);
+        std::memcpy(tail, p, n);
+        tailSize = n;
+    }
+
+    uint64_t digest() const
+    {
+        uint64_t h;
+        if (total >= 32) {
+            h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+            for (int i = 0; i < 4; ++i)
+                h = merge64(h, v[i]);
+        } else {
+            h = seed + P5;
+        }
+        h += total;
+
+        const unsigned char* p = tail;
+        size_t n = tailSize;
+        for (; n >= 8; p += 8, n -= 8)
+            h = rotl(h ^ round64(0, read64(p)), 27) * P1 + P4;
+        for (; n > 0; ++p, --n)
+            h = rotl(h ^ (*p * P5), 11) * P1;
+
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+};
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed)
+{
+    Hasher hs(seed);
+    hs.update(static_cast<const unsigned char*>(data), size);
+    return hs.digest();
+}
+
+uint64_t hashFile(const std::string& path)
+{
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        throw std::runtime_error("cannot open file: " + path);
+
+    Hasher hs(0);
+    std::vector<unsigned char> buf(1 << 20);
+    size_t n;
+    while ((n = std::fread(buf.data(), 1, buf.size(), f)) > 0)
+        hs.update(buf.data(), n);
+    // a read error also ends the loop; hashing what came before it would
+    // key the caches on a truncated file
+    const bool failed = std::ferror(f) != 0;
+    std::fclose(f);
+    if (failed)
+        throw std::runtime_error("cannot read file: " + path);
+    return hs.digest();
+}
+
+std::string hashHex(uint64_t h)
+{
+    char s[17];
+    std::snprintf(s, sizeof(s), "%016llx", static_cast<unsigned long long>(h));
+    return s;
+}
@@ -0,0 +1,18 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 64-bit non-cryptographic hash (four multiply-rotate lanes, xxHash64
+// style). Fast enough that hashing a file costs far less than decoding it.
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+// Hash of a file's contents, used as a content address for cached data.
+uint64_t hashFile(const std::string& path);
+
+// 16 lowercase hex digits.
+std::string hashHex(uint64_t h);
+
+#endif
@@ -1,96 +1,561 @@
+#include <limits>
 #include <vector>
-#include <math.h>
-#include <complex>
+#include <fcntl.h>
+#include <unistd.h>
 #include "matplotlib/matplotlibcpp.h"
+#include "analysis.hpp"
 #include "audio.hpp"
+#include "batch.hpp"
+#include "convolve.hpp"
+#include "correlate.hpp"
+#include "hash.hpp"
+#include "pcmcache.hpp"
+#include "peaks.hpp"
+#include "resample.hpp"
+#include "spectrumcache.hpp"
+#include "stft.hpp"
+#include "stream.hpp"
+#include "welch.hpp"
 
 using namespace std;
 namespace plt = matplotlibcpp;
-const double PI {acos(-1.0)};
-
-void fft(vector<complex<double>>& xs, bool invert = false){
-    int N = (int) xs.size();
-
-    if (N == 1)
-        return;
-
-    vector<complex<double>> es(N/2), os(N/2);
+// Plots n values spaced `stride` elements apart against the implicit axis
+// origin + i * step, without copying them into C++ vectors. With numpy the
+// values are wrapped in place, stride included, and numpy generates the
+// axis; without it both become Python lists. A label names the line in
+// the legend.
+template<typename T>
+bool plotSeries(const T* data, size_t n, size_t stride, double origin, double step,
+                const string& label = ""){
+    plt::detail::_interpreter::get();
+    PyObject *xs, *ys;
+#ifndef WITHOUT_NUMPY
+    npy_intp dims = (npy_intp) n;
+    npy_intp strides = (npy_intp) (stride * sizeof(T));
+    ys = PyArray_New(&PyArray_Type, 1, &dims, sizeof(T) == sizeof(float) ? NPY_FLOAT : NPY_DOUBLE,
+                     &strides, (void*) data, 0, NPY_ARRAY_ALIGNED, nullptr);
+    PyObject* index = PyArray_Arange(0.0, (double) n, 1.0, NPY_DOUBLE);
+    PyObject* scale = PyFloat_FromDouble(step);
+    PyObject* shift = PyFloat_FromDouble(origin);
+    PyObject* scaled = PyNumber_Multiply(index, scale);
+    xs = PyNumber_Add(scaled, shift);
+    Py_DECREF(scaled);
+    Py_DECREF(shift);
+    Py_DECREF(scale);
+    Py_DECREF(index);
+#else
+    xs = PyList_New(n);
+    ys = PyList_New(n);
+    for(size_t i = 0; i < n; ++i){
+        PyList_SetItem(xs, i, PyFloat_FromDouble(origin + i * step));
+        PyList_SetItem(ys, i, PyFloat_FromDouble(data[i * stride]));
+    }
+#endif
+    PyObject* args = PyTuple_New(2);
+    PyTuple_SetItem(args, 0, xs);
+    PyTuple_SetItem(args, 1, ys);
+    PyObject* kwargs = PyDict_New();
+    if(!label.empty()){
+        PyObject* name = PyUnicode_FromString(label.c_str());
+        PyDict_SetItemString(kwargs, "label", name);
+        Py_DECREF(name);
+    }
+    PyObject* res = PyObject_Call(plt::detail::_interpreter::get().s_python_function_plot, args, kwargs);
+    Py_DECREF(args);
+    Py_DECREF(kwargs);
+    if(res) Py_DECREF(res);
+    return res;
+}
 
-    for (int i = 0; i < N/2; ++i)
-        es[i] = xs[2*i];
+// Plots a view against its time axis.
+bool plotView(const AudioView& v){
+    return plotSeries(v.data, v.frames, v.stride, 0.0, 1.0 / v.sampleRate);
+}
 
-    for (int i = 0; i < N/2; ++i)
-        os[i] = xs[2*i + 1];
+// Shows the band [lo, hi] of a dB spectrogram as an image, time on the
+// x axis. Columns are max-pooled down to about `width` so an hour of
+// frames neither floods matplotlib nor hides short events.
+bool plotSpectrogram(const Spectrogram& sg, double lo, double hi, size_t width = 1600){
+#ifndef WITHOUT_NUMPY
+    size_t k0 = min(sg.bins - 1, (size_t) max(0.0, ceil(lo / sg.binHz)));
+    size_t k1 = min(sg.bins - 1, (size_t) max(0.0, floor(hi / sg.binHz)));
+    if(sg.frames == 0 || k1 < k0)
+        return false;
+    size_t pool = (sg.frames + width - 1) / width;
+    size_t cols = (sg.frames + pool - 1) / pool;
+    size_t rows = k1 - k0 + 1;
+    vector<float> image(rows * cols, numeric_limits<float>::lowest());
+    for(size_t f = 0; f < sg.frames; ++f){
+        const float* mag = sg.frame(f);
+        for(size_t r = 0; r < rows; ++r){
+            float& px = image[r * cols + f / pool];
+            px = max(px, mag[k0 + r]);
+        }
+    }
 
-    fft(es, invert);
-    fft(os, invert);
+    plt::detail::_interpreter::get();
+    npy_intp dims[2] = { (npy_intp) rows, (npy_intp) cols };
+    PyObject* array = PyArray_SimpleNewFromData(2, dims, NPY_FLOAT, image.data());
+    PyObject* extent = PyList_New(4);
+    PyList_SetItem(extent, 0, PyFloat_FromDouble(sg.time(0) - sg.hopSeconds / 2));
+    PyList_SetItem(extent, 1, PyFloat_FromDouble(sg.time(sg.frames - 1) + sg.hopSeconds / 2));
+    PyList_SetItem(extent, 2, PyFloat_FromDouble(k0 * sg.binHz));
+    PyList_SetItem(extent, 3, PyFloat_FromDouble(k1 * sg.binHz));
+    PyObject* args = PyTuple_New(1);
+    PyTuple_SetItem(args, 0, array);
+    PyObject* kwargs = PyDict_New();
+    PyDict_SetItemString(kwargs, "extent", extent);
+    Py_DECREF(extent);
+    PyObject* aspect = PyUnicode_FromString("auto");
+    PyDict_SetItemString(kwargs, "aspect", aspect);
+    Py_DECREF(aspect);
+    PyObject* origin = PyUnicode_FromString("lower");
+    PyDict_SetItemString(kwargs, "origin", origin);
+    Py_DECREF(origin);
+    PyObject* res = PyObject_Call(plt::detail::_interpreter::get().s_python_function_imshow, args, kwargs);
+    Py_DECREF(args);
+    Py_DECREF(kwargs);
+    if(res) Py_DECREF(res);
+    return res;
+#else
+    // images need numpy
+    (void) sg; (void) lo; (void) hi; (void) width;
+    return false;
+#endif
+}
 
-    auto signal = (invert ? 1 : -1);
-    auto theta = 2 * signal * PI / N;
-    complex<double> S { 1 }, S1 { cos(theta), sin(theta) };
+// Lists the strongest peaks of a spectrum slice starting at bin firstBin,
+// with interpolated frequencies.
+void printPeaks(const string& label, const double* mag, size_t bins, double binHz,
+                size_t firstBin, size_t count){
+    vector<Peak> peaks = findPeaks(mag, bins, binHz, count, PeakInterpolation::Gaussian, firstBin);
+    printf("Dominant frequencies (%s):", label.c_str());
+    for(const Peak& p : peaks)
+        printf(" %.2f Hz (%.4g)", p.frequency, p.magnitude);
+    printf("\n");
+}
 
-    for (int i = 0; i < N/2; ++i)
-    {
-        xs[i] = (es[i] + S * os[i]);
-        xs[i] /= (invert ? 2 : 1);
+// Opens a pipe, FIFO or "-" (stdin) for an AudioStream.
+int openStream(const string& path){
+    int fd = path == "-" ? 0 : open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        cerr << "Cannot open " << path << "\n";
+        exit(-1);
+    }
+    return fd;
+}
 
-        xs[i + N/2] = (es[i] - S * os[i]);
-        xs[i + N/2] /= (invert ? 2 : 1);
+// Filters a loaded signal in place, partitioned when filterBlock is set.
+void applyFilter(AudioData& data, const vector<float>& taps, size_t filterBlock){
+    if(filterBlock > 0)
+        filterChannelsPartitioned(data, taps, filterBlock);
+    else
+        filterChannels(data, taps);
+}
 
-        S *= S1;
+// Feeds every channel of a block source (AudioStream or AudioFileReader)
+// into its own Welch estimate as it is decoded, so the signal is never
+// held in memory. With taps, each channel goes through its own streaming
+// FIR filter first, cut back to the input length: a partitioned one with
+// blocks of filterBlock samples, or an FftConvolver if that is 0. A
+// nonzero rate converts the source to it on the way in.
+template<class Source>
+vector<Welch> welchChannels(Source& source, const WelchConfig& config, const vector<float>& taps,
+                            size_t filterBlock, uint32_t rate, ResampleQuality quality){
+    if(rate > 0 && rate != source.sampleRate()){
+        ResamplingReader reader([&source](float* dst, uint64_t frames){ return source.read(dst, frames); },
+                                source.channels(), source.sampleRate(), rate, quality);
+        return welchChannels(reader, config, taps, filterBlock, 0, quality);
+    }
+    const uint64_t blockFrames = 16384;
+    const uint32_t channels = source.channels();
+    vector<Welch> estimates;
+    vector<FftConvolver> filters;
+    vector<PartitionedConvolver> partitioned;
+    for(uint32_t c = 0; c < channels; ++c){
+        estimates.emplace_back(config, source.sampleRate());
+        if(taps.empty())
+            continue;
+        if(filterBlock > 0)
+            partitioned.emplace_back(taps, filterBlock);
+        else
+            filters.emplace_back(taps);
+    }
+    vector<float> block(blockFrames * channels), filtered;
+    uint64_t got, total = 0, pushed = 0;
+    while((got = source.read(block.data(), blockFrames)) > 0){
+        total += got;
+        for(uint32_t c = 0; c < channels; ++c){
+            if(taps.empty()){
+                estimates[c].push(block.data() + c, got, channels);
+                continue;
+            }
+            // every channel's filter has the same latency
+            filtered.clear();
+            if(filterBlock > 0)
+                partitioned[c].process(block.data() + c, got, channels, filtered);
+            else
+                filters[c].process(block.data() + c, got, channels, filtered);
+            estimates[c].push(filtered.data(), filtered.size());
+            if(c == 0)
+                pushed += filtered.size();
+        }
+        if(got < blockFrames)
+            break;
     }
+    for(uint32_t c = 0; !taps.empty() && c < channels; ++c){
+        filtered.clear();
+        if(filterBlock > 0)
+            partitioned[c].finish(filtered);
+        else
+            filters[c].finish(filtered);
+        estimates[c].push(filtered.data(), total - pushed);
+    }
+    return estimates;
 }
 
 int main(int argc, char** argv){
-    if(argc < 2){
+    string path, cacheDir, batchSpec, output = "batch.tsv", rawSpec;
+    unsigned threads = 0;
+    ChannelMix mix = ChannelMix::None;
+    uint64_t cacheMB = 4096;
+    double bandLo = 0.0, bandHi = 1000.0;
+    double start = 0.0, duration = -1.0;
+    StftConfig stft;
+    bool showStft = false;
+    WindowSpec window;
+    int peakCount = -1;
+    WelchConfig welch;
+    bool useWelch = false;
+    vector<float> taps;
+    size_t filterBlock = 0;
+    string delayPath;
+    long decimate = -1;
+    uint32_t rate = 0;
+    ResampleQuality quality = ResampleQuality::Medium;
+    for(int i = 1; i < argc; ++i){
+        string arg = argv[i];
+        if(arg == "--cache" && i + 1 < argc)
+            cacheDir = argv[++i];
+        else if(arg == "--cache-size" && i + 1 < argc)
+            cacheMB = stoull(argv[++i]);
+        else if(arg == "--band" && i + 1 < argc){
+            if(sscanf(argv[++i], "%lf:%lf", &bandLo, &bandHi) != 2 || !(bandLo < bandHi)){
+                cerr << "--band expects LO:HI in Hz with LO < HI\n";
+                exit(-1);
+            }
+        }
+        else if(arg == "--batch" && i + 1 < argc)
+            batchSpec = argv[++i];
+        else if(arg == "--output" && i + 1 < argc)
+            output = argv[++i];
+        else if(arg == "--threads" && i + 1 < argc)
+            threads = stoul(argv[++i]);
+        else if(arg == "--mix" && i + 1 < argc)
+            mix = parseChannelMix(argv[++i]);
+        else if(arg == "--raw" && i + 1 < argc)
+            rawSpec = argv[++i];
+        else if(arg == "--start" && i + 1 < argc)
+            start = stod(argv[++i]);
+        else if(arg == "--duration" && i + 1 < argc)
+            duration = stod(argv[++i]);
+        else if(arg == "--stft" && i + 1 < argc){
+            if(sscanf(argv[++i], "%zu:%zu", &stft.windowSize, &stft.hop) != 2
+               || stft.windowSize == 0 || stft.hop == 0){
+                cerr << "--stft expects WINDOW:HOP in samples, both positive\n";
+                exit(-1);
+            }
+            showStft = true;
+        }
+        else if(arg == "--welch" && i + 1 < argc){
+            // SEGMENT[:HOP], half-overlapped by default
+            string spec = argv[++i];
+            size_t colon = spec.find(':');
+            welch.segment = stoul(spec);
+            welch.hop = colon == string::npos ? welch.segment / 2 : stoul(spec.substr(colon + 1));
+            useWelch = true;
+        }
+        else if(arg == "--peaks" && i + 1 < argc)
+            peakCount = stoi(argv[++i]);
+        else if(arg == "--window" && i + 1 < argc)
+            window = parseWindow(argv[++i]);
+        else if(arg == "--filter" && i + 1 < argc)
+            taps = loadFilterTaps(argv[++i]);
+        else if(arg == "--filter-block" && i + 1 < argc)
+            filterBlock = stoul(argv[++i]);
+        else if(arg == "--delay" && i + 1 < argc)
+            delayPath = argv[++i];
+        else if(arg == "--decimate" && i + 1 < argc)
+            decimate = stol(argv[++i]);
+        else if(arg == "--rate" && i + 1 < argc)
+            rate = stoul(argv[++i]);
+        else if(arg == "--resample" && i + 1 < argc)
+            quality = parseResampleQuality(argv[++i]);
+        else
+            path = arg;
+    }
+
+    // batch mode writes a table instead of plotting, so Python never starts
+    if(!batchSpec.empty()){
+        vector<string> paths = batchInputs(batchSpec);
+        cout << "Analyzing " << paths.size() << " files...\n";
+        size_t peaks = peakCount < 0 ? 1 : peakCount;
+        vector<BatchResult> results = runBatch(paths, threads, peaks, rate, quality);
+        writeBatchResults(output, results, peaks);
+        size_t failed = 0;
+        for(const BatchResult& r : results)
+            failed += !r.error.empty();
+        cout << "Results written to " << output << " (" << failed << " failed)\n";
+        return 0;
+    }
+    if(path.empty()){
         cerr << "Audio file missing\n";
         exit(-1);
     }
-    
-    string path = argv[1];
+
+    // delay mode lines the first channel of another recording up against
+    // this one's with GCC-PHAT, and only prints the result
+    if(!delayPath.empty()){
+        bool ranged = start > 0.0 || duration >= 0.0;
+        AudioData ref = ranged ? loadAudioRange(path, start, duration) : loadAudioFile(path);
+        AudioData other = ranged ? loadAudioRange(delayPath, start, duration) : loadAudioFile(delayPath);
+        if(ref.sampleRate != other.sampleRate){
+            cout << "Converting " << delayPath << " to " << ref.sampleRate << " Hz...\n";
+            other = resampleChannels(other, ref.sampleRate, quality);
+        }
+        cout << "Correlating...\n";
+        CorrelationConfig config;
+        config.weighting = CorrelationWeighting::Phat;
+        double lag = crossCorrelate(channelView(other, 0), channelView(ref, 0), config).peakLag();
+        printf("%s lags %s by %.2f samples (%.3f ms)\n", delayPath.c_str(), path.c_str(), lag,
+               1000.0 * lag / ref.sampleRate);
+        return 0;
+    }
+    // caches hold whole files, so a time window bypasses them; a pipe can
+    // only be read once, so it bypasses them too
+    bool ranged = start > 0.0 || duration >= 0.0;
+    bool streamed = !rawSpec.empty() || isStreamPath(path);
+    if(ranged || streamed)
+        cacheDir.clear();
+
+    // Welch mode averages segment spectra as blocks are decoded, so even a
+    // long file costs a few segments of memory; only a time window is
+    // loaded whole
+    if(useWelch){
+        cout << "Estimating the power spectral density...\n";
+        welch.window = window;
+        vector<Welch> estimates;
+        if(streamed){
+            int fd = openStream(path);
+            if(rawSpec.empty()){
+                AudioStream stream(fd);
+                estimates = welchChannels(stream, welch, taps, filterBlock, rate, quality);
+            } else {
+                AudioStream stream(fd, parseRawFormat(rawSpec));
+                estimates = welchChannels(stream, welch, taps, filterBlock, rate, quality);
+            }
+            if(fd != 0)
+                close(fd);
+        } else if(ranged){
+            AudioData data = loadAudioRange(path, start, duration);
+            if(rate > 0 && rate != data.sampleRate)
+                data = resampleChannels(data, rate, quality);
+            if(!taps.empty())
+                applyFilter(data, taps, filterBlock);
+            for(uint32_t c = 0; c < data.channels; ++c){
+                AudioView v = channelView(data, c);
+                estimates.emplace_back(welch, data.sampleRate);
+                estimates.back().push(v.data, v.frames, v.stride);
+            }
+        } else {
+            AudioFileReader reader(path);
+            estimates = welchChannels(reader, welch, taps, filterBlock, rate, quality);
+        }
+
+        // the median of the band is a noise floor that tones barely move
+        vector<string> labels = spectrumLabels(estimates.size(), ChannelMix::None);
+        plt::figure();
+        for(size_t c = 0; c < estimates.size(); ++c){
+            vector<double> psd = estimates[c].psd();
+            double binHz = estimates[c].binHz();
+            for(double& p : psd)
+                p = 10.0 * log10(max(p, 1e-30));
+            size_t k0 = min(psd.size() - 1, (size_t) max(0.0, ceil(bandLo / binHz)));
+            size_t k1 = min(psd.size() - 1, (size_t) max(0.0, floor(bandHi / binHz)));
+            vector<double> band(psd.begin() + k0, psd.begin() + max(k0, k1) + 1);
+            nth_element(band.begin(), band.begin() + band.size() / 2, band.end());
+            printf("Noise floor (%s): %.1f dB/Hz over %llu segments\n", labels[c].c_str(),
+                   band[band.size() / 2], (unsigned long long) estimates[c].segments());
+            plotSeries(psd.data(), psd.size(), 1, 0.0, binHz, labels[c]);
+        }
+        plt::xlim(bandLo, bandHi);
+        plt::legend();
+        plt::xlabel("Frequency");
+        plt::ylabel("PSD (dB/Hz)");
+        plt::title("Welch PSD");
+        plt::tight_layout();
+        plt::show();
+        return 0;
+    }
+
+    // a band far below Nyquist is analysed at a lower rate: decimation by
+    // D shrinks the transform, and its memory, D times (--decimate 1 is off)
+    auto decimationFor = [&](uint32_t rate) -> size_t {
+        return decimate < 0 ? decimationFactor(rate, bandHi) : max(1L, decimate);
+    };
+
+    // spectra of converted, filtered or decimated audio are cached under
+    // the rate and quality, the filter's hash and the factor too
+    AudioInfo info;
+    if(!cacheDir.empty())
+        info = probeAudioFile(path);
+    uint32_t analysisRate = rate > 0 ? rate : info.sampleRate;
+    string spectrumTag = windowName(window);
+    if(rate > 0 && rate != info.sampleRate)
+        spectrumTag += "@" + to_string(rate) + ":" + resampleQualityName(quality);
+    if(!taps.empty())
+        spectrumTag += "+fir" + hashHex(hashBytes(taps.data(), taps.size() * sizeof(float)));
+    if(!cacheDir.empty() && decimationFor(analysisRate) > 1)
+        spectrumTag += "+dec" + to_string(decimationFor(analysisRate));
+
+    // cached spectra for this file and setup skip decoding entirely; the
+    // header says how many channel spectra to look for
+    uint64_t source = 0;
+    if(!cacheDir.empty()){
+        source = hashFile(path);
+        SpectrumCache spectra(cacheDir, cacheMB << 20);
+        vector<string> labels = spectrumLabels(info.channels, mix);
+        vector<Spectrum> hits(labels.size());
+        bool hit = true;
+        for(size_t i = 0; hit && i < labels.size(); ++i)
+            hit = spectra.load(SpectrumKey(source, 0, spectrumTag + "/" + labels[i]), bandLo, bandHi, hits[i]);
+        if(hit){
+            cout << "Spectrum found in cache\n";
+            for(size_t s = 0; s < hits.size(); ++s)
+                printPeaks(labels[s], hits[s].mag.data(), hits[s].mag.size(), hits[s].binHz,
+                           hits[s].firstBin, peakCount < 0 ? 5 : peakCount);
+            plt::figure();
+            for(size_t s = 0; s < hits.size(); ++s)
+                plotSeries(hits[s].mag.data(), hits[s].mag.size(), 1, hits[s].frequency(0),
+                           hits[s].binHz, labels[s]);
+            plt::xlim(bandLo, bandHi);
+            plt::legend();
+            plt::xlabel("Frequency");
+            plt::ylabel("Magnitude");
+            plt::title("Spectrum");
+            plt::tight_layout();
+            plt::show();
+            return 0;
+        }
+    }
+
     cout << "Loading audio...\n";
-    AudioData data = loadAudioFile(path);
-
-    int n = data.samples.size();
-    double val = 0, rate = data.sampleRate;
-    vector<double> x(n), y(n);
-    vector<complex<double>> Fy(n);
-    for(int i=0; i<n; ++i) {
-        double t = i / rate;
-        x[i] = t;
-        y[i] = data.samples[i];
-        Fy[i] = {y[i], 0};
+    Arena arena;
+    AudioData data(&arena);
+    // --rate converts streams and whole files block by block as they are
+    // decoded; a time window or cached PCM is converted once loaded
+    if(streamed){
+        // "-" is stdin; decoding keeps pace with the writer
+        int fd = openStream(path);
+        if(rawSpec.empty()){
+            AudioStream stream(fd);
+            data = rate > 0 ? loadStreamResampled(stream, rate, quality, &arena) : loadAudioStream(stream, &arena);
+        } else {
+            AudioStream stream(fd, parseRawFormat(rawSpec));
+            data = rate > 0 ? loadStreamResampled(stream, rate, quality, &arena) : loadAudioStream(stream, &arena);
+        }
+        if(fd != 0)
+            close(fd);
+    } else if(ranged){
+        data = loadAudioRange(path, start, duration, &arena);
+    } else if(cacheDir.empty()){
+        data = rate > 0 ? loadAudioResampled(path, rate, quality, &arena) : loadAudioFile(path, &arena);
+    } else {
+        PcmCache cache(cacheDir, cacheMB << 20);
+        data = loadAudioFileCached(path, source, cache, &arena);
     }
-    cout << "Applying the transform...\n";
-    fft(Fy);
-    int nh = n / 2 + 1;
-    double scale = 1.0 / n;
-    vector<double> freq(nh), mag(nh);
-    for(int i = 0; i < nh; i++){
-        freq[i] = i*rate/n;
-        mag[i] = 2.0*abs(Fy[i])/n;
+    if(rate > 0 && rate != data.sampleRate)
+        data = resampleChannels(data, rate, quality);
 
+    // the filter is causal, so the output lines up with the input
+    if(!taps.empty()){
+        cout << "Filtering (" << taps.size() << " taps)...\n";
+        applyFilter(data, taps, filterBlock);
     }
+
+    // the waveform plot keeps the full rate; the spectra see the band
+    AudioData low;
+    const AudioData* analysed = &data;
+    size_t factor = decimationFor(data.sampleRate);
+    if(factor > 1){
+        if(decimationBandHz(data.sampleRate, factor) < bandHi){
+            cerr << "--decimate " << factor << " keeps only "
+                 << decimationBandHz(data.sampleRate, factor) << " Hz, below the top of --band\n";
+            exit(-1);
+        }
+        cout << "Decimating by " << factor << " to " << data.sampleRate / factor << " Hz...\n";
+        low = decimateChannels(data, factor);
+        analysed = &low;
+    }
+
+    // one windowed transform per channel, plus the requested mixes
+    cout << "Applying the transform...\n";
+    ChannelSpectra spectra = analyzeChannels(*analysed, mix, 0, window);
+    if(!cacheDir.empty()){
+        SpectrumCache cache(cacheDir, cacheMB << 20);
+        for(size_t s = 0; s < spectra.mag.size(); ++s)
+            cache.store(SpectrumKey(source, 0, spectrumTag + "/" + spectra.labels[s]), spectra.binHz, spectra.mag[s]);
+    }
+    // peaks are looked for inside the plotted band
+    if(spectra.bins() > 0){
+        size_t k0 = (size_t) max(0.0, ceil(bandLo / spectra.binHz));
+        size_t k1 = min(spectra.bins() - 1, (size_t) max(0.0, floor(bandHi / spectra.binHz)));
+        for(size_t s = 0; k0 <= k1 && s < spectra.mag.size(); ++s)
+            printPeaks(spectra.labels[s], spectra.mag[s].data() + k0, k1 - k0 + 1, spectra.binHz,
+                       k0, peakCount < 0 ? 5 : peakCount);
+    }
+    // the spectrogram follows the first channel
+    Spectrogram sg;
+    if(showStft){
+        cout << "Computing the spectrogram...\n";
+        stft.window = window;
+        stft.scale = SpectrumScale::Decibels;
+        sg = Stft(stft).compute(channelView(data, 0));
+    }
+    const ArenaStats& st = arena.stats();
+    cout << "Decoder memory: " << st.allocations << " allocations, "
+         << st.reallocations << " reallocations, " << st.frees << " frees, peak "
+         << st.peakBytes << " bytes in " << st.chunks << " chunk(s)\n";
     // Set the size of output image to 1200x780 pixels
     plt::figure();  
     // Plot line from given x and y data. Color is selected automatically.
-    plt::subplot(2, 1, 1);
-    plt::plot(x, y);
+    long rows = showStft ? 3 : 2;
+    plt::subplot(rows, 1, 1);
+    for(uint32_t c = 0; c < data.channels; ++c)
+        plotView(channelView(data, c));
     plt::xlabel("Time");
     plt::ylabel("Amplitude");
     plt::title("Time Series");
 
 
-    plt::subplot(2, 1, 2);
-    plt::plot(freq, mag);
-    plt::xlim(0.0, 1000.0);
+    plt::subplot(rows, 1, 2);
+    for(size_t s = 0; s < spectra.mag.size(); ++s)
+        plotSeries(spectra.mag[s].data(), spectra.bins(), 1, 0.0, spectra.binHz, spectra.labels[s]);
+    plt::xlim(bandLo, bandHi);
     plt::xlabel("Frequency");
     plt::ylabel("Magnitude");
     plt::title("Spectrum");
+    // Enable legend.
+    plt::legend();
 
+    if(showStft){
+        plt::subplot(rows, 1, 3);
+        plotSpectrogram(sg, bandLo, bandHi);
+        plt::xlabel("Time");
+        plt::ylabel("Frequency");
+        plt::title("Spectrogram (dB)");
+    }
 
-    // Enable legend.
-    //plt::legend();
     plt::tight_layout();
     plt::show();
     return 0;
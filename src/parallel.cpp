@@ -0,0 +1,187 @@
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "parallel.hpp"
+
+unsigned workerCount()
+{
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+void parallelFor(size_t count, const std::function<void(size_t)>& fn, unsigned threads)
+{
+    if (threads == 0)
+        threads = workerCount();
+    if (threads > count)
+        threads = static_cast<unsigned>(count);
+
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorLock;
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorLock);
+                if (!error)
+                    error = std::current_exception();
+                next = count; // stop handing out work
+            }
+        }
+    };
+
+    // the calling thread works too
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// Which pool and deque the running thread works for, so submit() from a
+// task stays local.
+static thread_local const TaskPool* currentPool = nullptr;
+static thread_local unsigned currentWorker = 0;
+
+TaskPool::TaskPool(unsigned threads)
+{
+    if (threads == 0)
+        threads = workerCount();
+    for (unsigned i = 0; i < threads; ++i)
+        queues_.emplace_back(new Queue);
+    // deque 0 belongs to whichever thread calls wait()
+    for (unsigned i = 1; i < threads; ++i)
+        threads_.emplace_back(&TaskPool::workerLoop, this, i);
+}
+
+TaskPool::~TaskPool()
+{
+    try {
+        wait();
+    } catch (...) {
+    }
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& th : threads_)
+        th.join();
+}
+
+void TaskPool::submit(std::function<void()> task)
+{
+    unsigned target = currentWorker;
+    {
+        // counted before it becomes visible: a worker that takes the task
+        // right after the push must never decrement a counter still at 0
+        std::lock_guard<std::mutex> lock(lock_);
+        if (currentPool != this)
+            target = next_++ % size();
+        ++queued_;
+        ++pending_;
+    }
+    {
+        Queue& q = *queues_[target];
+        std::lock_guard<std::mutex> lock(q.lock);
+        q.tasks.push_back(std::move(task));
+    }
+    wake_.notify_one();
+    idle_.notify_one();
+}
+
+bool TaskPool::runOne(unsigned self)
+{
+    std::function<void()> task;
+    {
+        // own work, newest first
+        Queue& q = *queues_[self];
+        std::lock_guard<std::mutex> lock(q.lock);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        }
+    }
+    for (unsigned k = 1; !task && k < size(); ++k) {
+        // steal the oldest task of the next worker that has any
+        Queue& q = *queues_[(self + k) % size()];
+        std::lock_guard<std::mutex> lock(q.lock);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+    }
+    if (!task)
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        --queued_;
+    }
+    try {
+        task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (!error_)
+            error_ = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(lock_);
+    if (--pending_ == 0)
+        idle_.notify_all();
+    return true;
+}
+
+void TaskPool::workerLoop(unsigned self)
+{
+    currentPool   = this;
+    currentWorker = self;
+    for (;;) {
+        if (runOne(self))
+            continue;
+        std::unique_lock<std::mutex> lock(lock_);
+        wake_.wait(lock, [this] { return stop_ || queued_ > 0; });
+        if (stop_ && queued_ == 0)
+            return;
+    }
+}
+
+void TaskPool::wait()
+{
+    const TaskPool* outerPool = currentPool;
+    unsigned outerWorker = currentWorker;
+    currentPool   = this;
+    currentWorker = 0;
+    for (;;) {
+        if (runOne(0))
+            continue;
+        std::unique_lock<std::mutex> lock(lock_);
+        if (pending_ == 0)
+            break;
+        idle_.wait(lock, [this] { return pending_ == 0 || queued_ > 0; });
+    }
+    currentPool   = outerPool;
+    currentWorker = outerWorker;
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        std::swap(error, error_);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
@@ -0,0 +1,64 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Hardware threads available, at least 1.
+unsigned workerCount();
+
+// Runs fn(i) for every i in [0, count) on up to `threads` threads
+// (0 = workerCount()). Indices are handed out one by one, so uneven jobs
+// balance themselves. The first exception thrown by a job is rethrown.
+void parallelFor(size_t count, const std::function<void(size_t)>& fn,
+                 unsigned threads = 0);
+
+// Work-stealing pool of `threads` workers (0 = workerCount()); the thread
+// that calls wait() is one of them. Each worker owns a deque: it runs its
+// own tasks newest first and, when that runs dry, steals the oldest task
+// from another worker, so one long task never holds up the tasks queued
+// behind it.
+class TaskPool {
+public:
+    explicit TaskPool(unsigned threads = 0);
+    // Runs whatever is still queued, then joins the workers.
+    ~TaskPool();
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // From a task, queues on the running worker's own deque; from outside
+    // the pool, deals tasks out round-robin.
+    void submit(std::function<void()> task);
+    // Blocks until every submitted task has run, working meanwhile. The
+    // first exception thrown by a task is rethrown here.
+    void wait();
+    unsigned size() const { return static_cast<unsigned>(queues_.size()); }
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool runOne(unsigned self);
+    void workerLoop(unsigned self);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex lock_;
+    std::condition_variable wake_, idle_;
+    size_t queued_  = 0;    // tasks sitting in deques
+    size_t pending_ = 0;    // tasks submitted but not finished
+    unsigned next_  = 0;    // round-robin target for outside submits
+    bool stop_      = false;
+    std::exception_ptr error_;
+};
+
+#endif
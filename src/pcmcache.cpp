@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cachedir.hpp"
+#include "hash.hpp"
+#include "pcmcache.hpp"
+
+// Bump when the entry layout or the decoders' output changes.
+static const uint64_t CACHE_VERSION = 1;
+static const char MAGIC[8] = {'D', 'C', 'P', 'C', 'M', '0', '0', '1'};
+
+struct PcmHeader {
+    char     magic[8];
+    uint32_t sampleRate;
+    uint32_t channels;
+    uint64_t sampleCount;
+    uint64_t key;
+    char     pad[32];
+};
+static_assert(sizeof(PcmHeader) == 64, "cache header must keep samples 64-byte aligned");
+
+MappedPcm::~MappedPcm()
+{
+    if (base_)
+        munmap(base_, bytes_);
+}
+
+MappedPcm::MappedPcm(MappedPcm&& other) : base_(other.base_), bytes_(other.bytes_)
+{
+    other.base_ = nullptr;
+}
+
+MappedPcm& MappedPcm::operator=(MappedPcm&& other)
+{
+    std::swap(base_, other.base_);
+    std::swap(bytes_, other.bytes_);
+    return *this;
+}
+
+const float* MappedPcm::samples() const
+{
+    return reinterpret_cast<const float*>(static_cast<const char*>(base_) + sizeof(PcmHeader));
+}
+
+uint64_t MappedPcm::sampleCount() const { return static_cast<const PcmHeader*>(base_)->sampleCount; }
+uint32_t MappedPcm::sampleRate() const  { return static_cast<const PcmHeader*>(base_)->sampleRate; }
+uint32_t MappedPcm::channels() const    { return static_cast<const PcmHeader*>(base_)->channels; }
+
+AudioView MappedPcm::channel(uint32_t c) const
+{
+    if (c >= channels())
+        throw std::out_of_range("MappedPcm: no channel " + std::to_string(c));
+    return AudioView(samples() + c, sampleCount() / channels(), channels(), sampleRate());
+}
+
+PcmCache::PcmCache(const std::string& dir, uint64_t maxBytes) : dir_(dir), maxBytes_(maxBytes)
+{
+    ensureCacheDir(dir_);
+}
+
+uint64_t PcmCache::keyOf(uint64_t sourceHash)
+{
+    return sourceHash ^ (CACHE_VERSION * 0x9E3779B97F4A7C15ULL);
+}
+
+std::string PcmCache::entryPath(uint64_t key) const
+{
+    return dir_ + "/" + hashHex(key) + ".pcm";
+}
+
+MappedPcm PcmCache::open(uint64_t key) const
+{
+    MappedPcm map;
+    const std::string path = entryPath(key);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return map;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PcmHeader))) {
+        ::close(fd);
+        return map;
+    }
+
+    void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED)
+        return map;
+
+    const PcmHeader* h = static_cast<const PcmHeader*>(base);
+    const uint64_t expected = sizeof(PcmHeader) + h->sampleCount * sizeof(float);
+    if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->key != key
+        || expected != static_cast<uint64_t>(st.st_size)) {
+        munmap(base, st.st_size);
+        return map;
+    }
+
+    touchCacheEntry(path);
+    map.base_  = base;
+    map.bytes_ = st.st_size;
+    return map;
+}
+
+void PcmCache::store(uint64_t key, const AudioData& data)
+{
+    if (data.layout != SampleLayout::Interleaved)
+        return;     // entries are interleaved, see loadAudioFileCached()
+
+    PcmHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.sampleRate  = data.sampleRate;
+    h.channels    = data.channels;
+    h.sampleCount = data.samples.size();
+    h.key         = key;
+
+    // the cache is best effort, a read-only dir just means misses
+    if (writeCacheEntry(entryPath(key), &h, sizeof(h),
+                        data.samples.data(), data.samples.size() * sizeof(float)))
+        evict();
+}
+
+void PcmCache::evict()
+{
+    evictCacheEntries(dir_, ".pcm", maxBytes_);
+}
+
+AudioData loadAudioFileCached(const std::string& path, PcmCache& cache, Arena* arena)
+{
+    return loadAudioFileCached(path, hashFile(path), cache, arena);
+}
+
+AudioData loadAudioFileCached(const std::string& path, uint64_t sourceHash,
+                              PcmCache& cache, Arena* arena)
+{
+    const uint64_t key = PcmCache::keyOf(sourceHash);
+
+    MappedPcm hit = cache.open(key);
+    if (hit.valid()) {
+        AudioData out(arena);
+        out.sampleRate = hit.sampleRate();
+        out.channels   = hit.channels();
+        out.samples.assign(hit.samples(), hit.samples() + hit.sampleCount());
+        return out;
+    }
+
+    AudioData out = loadAudioFile(path, arena);
+    cache.store(key, out);
+    return out;
+}
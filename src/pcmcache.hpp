@@ -0,0 +1,67 @@
+#ifndef PCMCACHE_HPP
+#define PCMCACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include "audio.hpp"
+
+// Read-only memory map of one cache entry.
+class MappedPcm {
+public:
+    MappedPcm() {}
+    ~MappedPcm();
+    MappedPcm(MappedPcm&& other);
+    MappedPcm& operator=(MappedPcm&& other);
+    MappedPcm(const MappedPcm&) = delete;
+    MappedPcm& operator=(const MappedPcm&) = delete;
+
+    bool valid() const { return base_ != nullptr; }
+    const float* samples() const;
+    uint64_t sampleCount() const;
+    uint32_t sampleRate() const;
+    uint32_t channels() const;
+
+    // Channel c of the mapped samples, read in place.
+    AudioView channel(uint32_t c) const;
+
+private:
+    friend class PcmCache;
+    void*  base_  = nullptr;
+    size_t bytes_ = 0;
+};
+
+// Directory of decoded f32 PCM keyed by a hash of the source file. Each
+// entry is a 64-byte header followed by the interleaved samples, so it can
+// be mapped and used in place. Entry mtimes record last use; store() evicts
+// the least recently used entries until the directory fits in maxBytes.
+// Entries are written to a temporary name and renamed, so several
+// processes can share a directory.
+class PcmCache {
+public:
+    explicit PcmCache(const std::string& dir, uint64_t maxBytes = 4ULL << 30);
+
+    // Maps the entry for `key`, or returns an invalid map on a miss.
+    MappedPcm open(uint64_t key) const;
+    // Only interleaved data is stored; planar data is skipped.
+    void store(uint64_t key, const AudioData& data);
+    void evict();
+
+    // Content address of a source file, from its hashFile() value.
+    static uint64_t keyOf(uint64_t sourceHash);
+
+private:
+    std::string entryPath(uint64_t key) const;
+
+    std::string dir_;
+    uint64_t maxBytes_;
+};
+
+// loadAudioFile() that checks the cache first and fills it on a miss.
+AudioData loadAudioFileCached(const std::string& path, PcmCache& cache,
+                              Arena* arena = nullptr);
+
+// Same, for callers that already hashed the file with hashFile().
+AudioData loadAudioFileCached(const std::string& path, uint64_t sourceHash,
+                              PcmCache& cache, Arena* arena = nullptr);
+
+#endif
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <cmath>
+#include "peaks.hpp"
+
+// Smallest neighbour, relative to the peak, still taken to be part of the
+// window's main lobe. Hann leaves 0.2 at worst; anything lower is a null
+// or noise, and a log fit through it overshoots.
+static const double GAUSSIAN_MIN_NEIGHBOUR = 0.1;
+
+// Vertex of the parabola through (-1, a), (0, b), (1, c): the offset from
+// the middle bin, within ±0.5 for a true maximum, and the height there.
+static void parabolaVertex(double a, double b, double c, double& offset, double& height)
+{
+    const double curve = a - 2 * b + c;
+    offset = curve < 0 ? 0.5 * (a - c) / curve : 0.0;
+    height = b - 0.25 * (a - c) * offset;
+}
+
+std::vector<Peak> findPeaks(const double* mag, size_t bins, double binHz, size_t count,
+                            PeakInterpolation interp, size_t firstBin)
+{
+    std::vector<Peak> peaks;
+    for (size_t i = 1; i + 1 < bins; ++i) {
+        const double a = mag[i - 1], b = mag[i], c = mag[i + 1];
+        if (!(b > a && b >= c))
+            continue;
+        double offset = 0, height = b;
+        const bool lobe = a >= GAUSSIAN_MIN_NEIGHBOUR * b && c >= GAUSSIAN_MIN_NEIGHBOUR * b;
+        if (interp == PeakInterpolation::Gaussian && lobe) {
+            parabolaVertex(std::log(a), std::log(b), std::log(c), offset, height);
+            height = std::exp(height);
+        } else if (interp != PeakInterpolation::None) {
+            parabolaVertex(a, b, c, offset, height);
+        }
+        Peak p;
+        p.frequency = (firstBin + i + offset) * binHz;
+        p.magnitude = height;
+        peaks.push_back(p);
+    }
+
+    // ties go to the lower frequency, so the ranking is fully determined
+    auto stronger = [](const Peak& a, const Peak& b) {
+        return a.magnitude > b.magnitude || (a.magnitude == b.magnitude && a.frequency < b.frequency);
+    };
+    if (peaks.size() > count) {
+        std::nth_element(peaks.begin(), peaks.begin() + count, peaks.end(), stronger);
+        peaks.resize(count);
+    }
+    std::sort(peaks.begin(), peaks.end(), stronger);
+    return peaks;
+}
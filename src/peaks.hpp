@@ -0,0 +1,31 @@
+#ifndef PEAKS_HPP
+#define PEAKS_HPP
+
+#include <cstddef>
+#include <vector>
+
+// How a peak's position and height are refined from its bin and the two
+// neighbours: a parabola through the magnitudes, or through their logs
+// (exact for a Gaussian, close to what a Hann or Kaiser window leaves).
+// Gaussian falls back to the parabola when a neighbour drops so low that
+// it cannot belong to the main lobe, as in the nulls of an unwindowed
+// spectrum or in noise.
+enum class PeakInterpolation { None, Parabolic, Gaussian };
+
+struct Peak {
+    double frequency = 0;
+    double magnitude = 0;
+};
+
+// The `count` strongest local maxima of mag[0, bins), strongest first.
+// mag[i] is bin firstBin + i of a spectrum with bins binHz apart. A local
+// maximum is higher than its left neighbour and no lower than its right
+// one, so the ends of the range are never peaks and a plateau counts once.
+// Every maximum is interpolated first and ranked by its refined height;
+// nth_element narrows them to the top `count`, so the cost stays linear
+// in the number of bins.
+std::vector<Peak> findPeaks(const double* mag, size_t bins, double binHz, size_t count,
+                            PeakInterpolation interp = PeakInterpolation::Gaussian,
+                            size_t firstBin = 0);
+
+#endif
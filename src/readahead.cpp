@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "readahead.hpp"
+
+ReadAhead::ReadAhead(const std::string& path, size_t blockSize, size_t depth)
+{
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        throw std::runtime_error("cannot open file: " + path);
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("cannot stat file: " + path);
+    }
+    size_ = st.st_size;
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    buffers_.resize(depth ? depth : 1, std::vector<char>(blockSize));
+    for (auto& b : buffers_)
+        free_.push_back(&b);
+    worker_ = std::thread(&ReadAhead::fetchLoop, this);
+}
+
+ReadAhead::~ReadAhead()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    worker_.join();
+    ::close(fd_);
+}
+
+void ReadAhead::fetchLoop()
+{
+    std::unique_lock<std::mutex> guard(lock_);
+    for (;;) {
+        wake_.wait(guard, [this] {
+            return stop_ || (!free_.empty() && fetchPos_ < size_ && !error_);
+        });
+        if (stop_)
+            return;
+
+        std::vector<char>* buf = free_.back();
+        free_.pop_back();
+        const int64_t  offset = fetchPos_;
+        const uint64_t gen    = generation_;
+        guard.unlock();
+
+        // pread keeps no shared cursor, so seeks never race with the worker
+        size_t got = 0;
+        int err = 0;
+        while (got < buf->size() && offset + static_cast<int64_t>(got) < size_) {
+            ssize_t n = ::pread(fd_, buf->data() + got, buf->size() - got, offset + got);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                err = n < 0 ? errno : EIO;
+                break;
+            }
+            got += static_cast<size_t>(n);
+        }
+
+        guard.lock();
+        if (gen != generation_) {
+            free_.push_back(buf);       // a seek made this block stale
+        } else if (err) {
+            free_.push_back(buf);
+            error_ = err;
+        } else {
+            ready_.push_back(Block{offset, got, buf});
+            fetchPos_ = offset + got;
+        }
+        wake_.notify_all();
+    }
+}
+
+void ReadAhead::restartAt(int64_t offset)
+{
+    // caller holds lock_
+    for (auto& b : ready_)
+        free_.push_back(b.data);
+    ready_.clear();
+    fetchPos_ = offset;
+    error_ = 0;
+    ++generation_;
+    wake_.notify_all();
+}
+
+size_t ReadAhead::read(void* dst, size_t bytes)
+{
+    char* out = static_cast<char*>(dst);
+    size_t done = 0;
+
+    std::unique_lock<std::mutex> guard(lock_);
+    while (done < bytes && pos_ < size_) {
+        wake_.wait(guard, [this] { return !ready_.empty() || error_; });
+        if (ready_.empty())
+            break;      // I/O error: report a short read like fread would
+
+        Block& front = ready_.front();
+        const size_t skip = static_cast<size_t>(pos_ - front.offset);
+        const size_t n = std::min(front.size - skip, bytes - done);
+        std::memcpy(out + done, front.data->data() + skip, n);
+        done += n;
+        pos_ += n;
+
+        if (skip + n == front.size) {
+            free_.push_back(front.data);
+            ready_.pop_front();
+            wake_.notify_all();
+        }
+    }
+    return done;
+}
+
+bool ReadAhead::seek(int64_t offset, int origin)
+{
+    int64_t target = offset;
+    if (origin == 1)
+        target += pos_;
+    else if (origin == 2)
+        target += size_;
+    if (target < 0 || target > size_)
+        return false;
+
+    std::lock_guard<std::mutex> guard(lock_);
+    pos_ = target;
+
+    // drop consumed blocks; keep the queue if the target is still ahead in it
+    while (!ready_.empty() && ready_.front().offset + static_cast<int64_t>(ready_.front().size) <= target) {
+        free_.push_back(ready_.front().data);
+        ready_.pop_front();
+        wake_.notify_all();
+    }
+    if (!ready_.empty() && ready_.front().offset <= target)
+        return true;
+    if (ready_.empty() && fetchPos_ == target)
+        return true;    // the worker is already fetching from here
+
+    restartAt(target);
+    return true;
+}
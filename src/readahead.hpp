@@ -0,0 +1,77 @@
+#ifndef READAHEAD_HPP
+#define READAHEAD_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Sequential file reader that keeps the next `depth` blocks in flight on a
+// background thread, so a decoder pulling bytes through onRead() overlaps
+// its CPU work with the I/O for the following blocks. Seeks that land in a
+// block already fetched are free; any other seek drops the queue and
+// restarts the prefetch at the new offset.
+//
+// The on* functions match the dr_wav/dr_mp3/dr_flac read, seek and tell
+// callbacks; pass the ReadAhead as pUserData.
+class ReadAhead {
+public:
+    explicit ReadAhead(const std::string& path, size_t blockSize = 4 << 20, size_t depth = 2);
+    ~ReadAhead();
+    ReadAhead(const ReadAhead&) = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+
+    size_t read(void* dst, size_t bytes);
+    bool seek(int64_t offset, int origin);    // origin: 0 start, 1 current, 2 end
+    int64_t tell() const { return pos_; }
+    int64_t size() const { return size_; }
+
+    static size_t onRead(void* self, void* dst, size_t bytes)
+    {
+        return static_cast<ReadAhead*>(self)->read(dst, bytes);
+    }
+
+    template <typename Bool, typename Origin>
+    static Bool onSeek(void* self, int offset, Origin origin)
+    {
+        return static_cast<ReadAhead*>(self)->seek(offset, static_cast<int>(origin)) ? 1 : 0;
+    }
+
+    template <typename Bool, typename Int>
+    static Bool onTell(void* self, Int* cursor)
+    {
+        *cursor = static_cast<Int>(static_cast<ReadAhead*>(self)->tell());
+        return 1;
+    }
+
+private:
+    struct Block {
+        int64_t offset;
+        size_t  size;
+        std::vector<char>* data;
+    };
+
+    void fetchLoop();
+    void restartAt(int64_t offset);
+
+    int fd_ = -1;
+    int64_t size_ = 0;
+    int64_t pos_ = 0;               // consumer position
+
+    std::vector<std::vector<char>> buffers_;
+    std::vector<std::vector<char>*> free_;
+    std::deque<Block> ready_;
+    int64_t fetchPos_ = 0;          // next offset the worker reads
+    uint64_t generation_ = 0;       // bumped by every restart
+    bool stop_ = false;
+    int error_ = 0;
+
+    std::mutex lock_;
+    std::condition_variable wake_;
+    std::thread worker_;
+};
+
+#endif
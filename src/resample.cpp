@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include "convert.hpp"
+#include "parallel.hpp"
+#include "resample.hpp"
+#include "stream.hpp"
+#include "window.hpp"
+
+// How far the decimated Nyquist sits above the band it keeps; the
+// decimation filter's passband is 1 / DECIMATE_MARGIN of that Nyquist.
+static const double DECIMATE_MARGIN = 1.2;
+
+// Most sub-filters stored for an exact ratio. Every pair of common rates
+// stays below it (44.1 to 48 kHz takes 160, 11.025 to 48 kHz 640); odd
+// pairs that reduce to more phases get RESAMPLE_INTERPOLATED_PHASES and
+// interpolate between them.
+static const size_t RESAMPLE_MAX_PHASES = 1024;
+static const size_t RESAMPLE_INTERPOLATED_PHASES = 512;
+
+// Frames ResamplingReader pulls from its source at a time.
+static const uint64_t RESAMPLE_BLOCK_FRAMES = 16384;
+
+static size_t gcd(size_t a, size_t b)
+{
+    while (b != 0) {
+        const size_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+// Kaiser's formulas for the window shape and the filter length that reach
+// `attenuationDb` across a transition `width` cycles per sample wide.
+static double kaiserBeta(double attenuationDb)
+{
+    if (attenuationDb > 50)
+        return 0.1102 * (attenuationDb - 8.7);
+    if (attenuationDb > 21)
+        return 0.5842 * std::pow(attenuationDb - 21, 0.4) + 0.07886 * (attenuationDb - 21);
+    return 0;
+}
+
+static double kaiserLength(double attenuationDb, double width)
+{
+    return (attenuationDb - 7.95) / (14.36 * width);
+}
+
+// Filter tables are built once per (ratio, config) and shared by every
+// resampler using them; a run only ever meets a handful of rate pairs.
+static std::shared_ptr<const PolyphaseTable> polyphaseTable(size_t up, size_t down,
+                                                            const ResamplerConfig& config)
+{
+    typedef std::tuple<size_t, size_t, double, double, double> Key;
+    static std::mutex lock;
+    static std::map<Key, std::shared_ptr<const PolyphaseTable>> tables;
+
+    const Key key(up, down, config.passband, config.stopband, config.attenuationDb);
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = tables.find(key);
+    if (it != tables.end())
+        return it->second;
+
+    // the lower Nyquist in cycles per input sample
+    const double nyquist = 0.5 * std::min(1.0, static_cast<double>(up) / down);
+    const double cutoff = 0.5 * (config.passband + config.stopband) * nyquist;
+    const double width = (config.stopband - config.passband) * nyquist;
+    const double length = std::ceil(kaiserLength(config.attenuationDb, width));
+    std::shared_ptr<PolyphaseTable> table = std::make_shared<PolyphaseTable>();
+    const size_t taps = std::max<size_t>(2, (static_cast<size_t>(length) + 1) / 2 * 2);
+    const size_t phases = up <= RESAMPLE_MAX_PHASES ? up : RESAMPLE_INTERPOLATED_PHASES;
+    table->taps = taps;
+    table->phases = phases;
+
+    // the impulse response sampled every 1/phases inputs: the periodic
+    // window of taps * phases points is symmetric about its middle
+    // sample, which becomes the centre of the sinc
+    const size_t n = taps * phases;
+    const std::shared_ptr<const WindowTable> w =
+        windowTable(WindowSpec(WindowType::Kaiser, kaiserBeta(config.attenuationDb)), n);
+    const double pi = std::acos(-1.0);
+    const double step = cutoff / phases;
+    table->coefficients.assign(n + (phases < up ? taps : 0), 0.0f);
+    for (size_t k = 0; k < n; ++k) {
+        const double t = static_cast<double>(k) - n / 2.0;
+        const double sinc = t == 0 ? 1.0 : std::sin(2 * pi * step * t) / (2 * pi * step * t);
+        // tap j of phase p meets the input j samples before the newest
+        // one it reads
+        const size_t p = k % phases, j = k / phases;
+        table->coefficients[p * taps + (taps - 1 - j)] =
+            static_cast<float>(2 * cutoff * sinc * w->values[k]);
+    }
+    // interpolated tables end with phase 1, which is phase 0 one input on
+    if (phases < up)
+        std::copy(table->coefficients.begin(), table->coefficients.begin() + taps - 1,
+                  table->coefficients.begin() + n + 1);
+    tables[key] = table;
+    return table;
+}
+
+PolyphaseResampler::PolyphaseResampler(size_t up, size_t down, const ResamplerConfig& config)
+{
+    if (up == 0 || down == 0)
+        throw std::runtime_error("resample: factors must be positive");
+    if (!(config.passband > 0) || !(config.stopband > config.passband) || config.stopband > 2)
+        throw std::runtime_error("resample: need 0 < passband < stopband <= 2");
+    const size_t g = gcd(up, down);
+    up_ = up / g;
+    down_ = down / g;
+    table_ = polyphaseTable(up_, down_, config);
+    taps_ = table_->taps;
+    reset();
+}
+
+void PolyphaseResampler::run(std::vector<float>& out)
+{
+    for (;;) {
+        const int64_t newest = static_cast<int64_t>(next_ / up_);
+        if (newest - first_ >= static_cast<int64_t>(input_.size()))
+            break;
+        const float* x = input_.data() + (newest - first_ - static_cast<int64_t>(taps_) + 1);
+        const float* c = table_->coefficients.data();
+        if (table_->phases == up_) {
+            out.push_back(dotProduct(c + (next_ % up_) * taps_, x, taps_));
+        } else {
+            // between two of the table's phases, linearly
+            const double at = static_cast<double>(next_ % up_) * table_->phases / up_;
+            const size_t p = static_cast<size_t>(at);
+            const double frac = at - p;
+            const double a = dotProduct(c + p * taps_, x, taps_);
+            const double b = dotProduct(c + (p + 1) * taps_, x, taps_);
+            out.push_back(static_cast<float>(a + frac * (b - a)));
+        }
+        next_ += down_;
+        ++produced_;
+    }
+    const int64_t keep = static_cast<int64_t>(next_ / up_) - static_cast<int64_t>(taps_) + 1;
+    if (keep > first_) {
+        const size_t drop = std::min(input_.size(), static_cast<size_t>(keep - first_));
+        input_.erase(input_.begin(), input_.begin() + drop);
+        first_ += drop;
+    }
+}
+
+void PolyphaseResampler::process(const float* src, size_t count, size_t stride,
+                                 std::vector<float>& out)
+{
+    for (size_t i = 0; i < count; ++i)
+        input_.push_back(src[i * stride]);
+    consumed_ += count;
+    run(out);
+}
+
+void PolyphaseResampler::finish(std::vector<float>& out)
+{
+    const uint64_t total = (consumed_ * up_ + down_ - 1) / down_;
+    const size_t before = out.size();
+    const uint64_t producedBefore = produced_;
+    while (produced_ < total) {
+        input_.resize(input_.size() + taps_, 0.0f);
+        run(out);
+    }
+    out.resize(before + (total - producedBefore));
+    reset();
+}
+
+void PolyphaseResampler::reset()
+{
+    // output 0 is centred on input 0 and reaches taps_ / 2 - 1 inputs
+    // before it, silence before the stream starts
+    first_ = 1 - static_cast<int64_t>(taps_ / 2);
+    input_.assign(static_cast<size_t>(-first_), 0.0f);
+    next_ = taps_ * up_ / 2;
+    consumed_ = 0;
+    produced_ = 0;
+}
+
+double decimationBandHz(uint32_t rate, size_t factor)
+{
+    return static_cast<double>(rate) / factor / (2 * DECIMATE_MARGIN);
+}
+
+size_t decimationFactor(uint32_t rate, double bandHz)
+{
+    if (!(bandHz > 0))
+        return 1;
+    for (size_t d = rate / 2; d >= 2; --d)
+        if (rate % d == 0 && decimationBandHz(rate, d) >= bandHz)
+            return d;
+    return 1;
+}
+
+// Runs a copy of `prototype` over every channel of `data` into planar
+// output at `rate`.
+static AudioData resampleWith(const AudioData& data, const PolyphaseResampler& prototype,
+                              uint32_t rate, unsigned threads)
+{
+    AudioData out;
+    out.sampleRate  = rate;
+    out.channels    = data.channels;
+    out.layout      = SampleLayout::Planar;
+    out.planeFrames = (data.frames() * prototype.up() + prototype.down() - 1) / prototype.down();
+    out.planeStride = (out.planeFrames + 15) / 16 * 16;
+    out.samples.resize(out.planeStride * out.channels);
+
+    parallelFor(data.channels, [&](size_t c) {
+        const AudioView v = channelView(data, static_cast<uint32_t>(c));
+        PolyphaseResampler r(prototype);
+        std::vector<float> y;
+        y.reserve(out.planeFrames);
+        r.process(v.data, v.frames, v.stride, y);
+        r.finish(y);
+        std::copy(y.begin(), y.end(), out.plane(static_cast<uint32_t>(c)));
+    }, threads);
+    return out;
+}
+
+AudioData decimateChannels(const AudioData& data, size_t factor, unsigned threads)
+{
+    if (factor == 0 || data.sampleRate % factor != 0)
+        throw std::runtime_error("resample: " + std::to_string(factor) + " does not divide " +
+                                 std::to_string(data.sampleRate) + " Hz");
+    const uint32_t rate = static_cast<uint32_t>(data.sampleRate / factor);
+    // a fixed fraction of the new Nyquist, not the requested band: the
+    // spectrum cache keys decimated spectra by the factor only
+    ResamplerConfig config;
+    config.passband = 1 / DECIMATE_MARGIN;
+    config.stopband = 2 - config.passband;
+    return resampleWith(data, PolyphaseResampler(1, factor, config), rate, threads);
+}
+
+AudioData resampleChannels(const AudioData& data, uint32_t rate, ResampleQuality quality,
+                           unsigned threads)
+{
+    if (rate == 0 || data.sampleRate == 0)
+        throw std::runtime_error("resample: sample rates must be positive");
+    return resampleWith(data, PolyphaseResampler(rate, data.sampleRate, resamplerConfig(quality)),
+                        rate, threads);
+}
+
+ResampleQuality parseResampleQuality(const std::string& name)
+{
+    if (name == "fast")
+        return ResampleQuality::Fast;
+    if (name == "medium")
+        return ResampleQuality::Medium;
+    if (name == "best")
+        return ResampleQuality::Best;
+    throw std::runtime_error("resample: unknown quality '" + name + "' (fast, medium or best)");
+}
+
+std::string resampleQualityName(ResampleQuality quality)
+{
+    switch (quality) {
+    case ResampleQuality::Fast:   return "fast";
+    case ResampleQuality::Medium: return "medium";
+    case ResampleQuality::Best:   return "best";
+    }
+    return "";
+}
+
+ResamplerConfig resamplerConfig(ResampleQuality quality)
+{
+    ResamplerConfig c;
+    switch (quality) {
+    case ResampleQuality::Fast:   c.passband = 0.80; c.attenuationDb = 60;  break;
+    case ResampleQuality::Medium: c.passband = 0.90; c.attenuationDb = 90;  break;
+    case ResampleQuality::Best:   c.passband = 0.95; c.attenuationDb = 120; break;
+    }
+    c.stopband = 1.0;
+    return c;
+}
+
+ResamplingReader::ResamplingReader(std::function<uint64_t(float*, uint64_t)> read,
+                                   uint32_t channels, uint32_t fromRate, uint32_t toRate,
+                                   ResampleQuality quality)
+    : source_(std::move(read)), channels_(channels), rate_(toRate), pending_(channels)
+{
+    if (fromRate == 0 || toRate == 0)
+        throw std::runtime_error("resample: sample rates must be positive");
+    // a matching rate passes straight through
+    if (fromRate != toRate) {
+        resamplers_.assign(channels, PolyphaseResampler(toRate, fromRate, resamplerConfig(quality)));
+        block_.resize(RESAMPLE_BLOCK_FRAMES * channels);
+    }
+}
+
+uint64_t ResamplingReader::read(float* dst, uint64_t frames)
+{
+    if (resamplers_.empty())
+        return source_(dst, frames);
+
+    for (std::vector<float>& p : pending_)
+        p.erase(p.begin(), p.begin() + offset_);
+    offset_ = 0;
+    while (!done_ && channels_ > 0 && pending_[0].size() < frames) {
+        const uint64_t got = source_(block_.data(), RESAMPLE_BLOCK_FRAMES);
+        for (uint32_t c = 0; c < channels_; ++c)
+            resamplers_[c].process(block_.data() + c, got, channels_, pending_[c]);
+        if (got < RESAMPLE_BLOCK_FRAMES) {
+            for (uint32_t c = 0; c < channels_; ++c)
+                resamplers_[c].finish(pending_[c]);
+            done_ = true;
+        }
+    }
+
+    // every channel has the same ratio, so the same count is ready
+    const uint64_t n = channels_ > 0 ? std::min<uint64_t>(frames, pending_[0].size()) : 0;
+    for (uint32_t c = 0; c < channels_; ++c) {
+        const float* src = pending_[c].data();
+        for (uint64_t f = 0; f < n; ++f)
+            dst[f * channels_ + c] = src[f];
+    }
+    offset_ = static_cast<size_t>(n);
+    return n;
+}
+
+// Reads a converted source to its end, `expected` frames reserved up front
+// when the length is known.
+static AudioData readAll(ResamplingReader& reader, uint64_t expected, Arena* arena)
+{
+    AudioData out(arena);
+    out.sampleRate = reader.sampleRate();
+    out.channels   = reader.channels();
+    out.samples.reserve(static_cast<size_t>(expected) * out.channels);
+
+    uint64_t frames = 0;
+    for (;;) {
+        out.samples.resize((frames + RESAMPLE_BLOCK_FRAMES) * out.channels);
+        const uint64_t got = reader.read(out.samples.data() + frames * out.channels,
+                                         RESAMPLE_BLOCK_FRAMES);
+        frames += got;
+        if (got < RESAMPLE_BLOCK_FRAMES)
+            break;
+    }
+    out.samples.resize(frames * out.channels);
+    return out;
+}
+
+AudioData loadAudioResampled(const std::string& path, uint32_t rate, ResampleQuality quality,
+                             Arena* arena, unsigned threads)
+{
+    const AudioInfo info = probeAudioFile(path);
+    if (info.sampleRate == rate)
+        return loadAudioFile(path, arena, SampleLayout::Interleaved, threads);
+    AudioFileReader file(path);
+    ResamplingReader reader([&file](float* dst, uint64_t frames) { return file.read(dst, frames); },
+                            file.channels(), file.sampleRate(), rate, quality);
+    // one block of slack for the rounding of the converted length
+    const uint64_t expected = info.frameCount * rate / std::max<uint32_t>(1, info.sampleRate);
+    return readAll(reader, expected + RESAMPLE_BLOCK_FRAMES, arena);
+}
+
+AudioData loadStreamResampled(AudioStream& stream, uint32_t rate, ResampleQuality quality,
+                              Arena* arena)
+{
+    if (stream.sampleRate() == rate)
+        return loadAudioStream(stream, arena);
+    ResamplingReader reader([&stream](float* dst, uint64_t frames) { return stream.read(dst, frames); },
+                            stream.channels(), stream.sampleRate(), rate, quality);
+    return readAll(reader, 0, arena);
+}
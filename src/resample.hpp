@@ -0,0 +1,155 @@
+#ifndef RESAMPLE_HPP
+#define RESAMPLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "audio.hpp"
+
+class AudioStream;
+
+// The anti-aliasing low-pass, in fractions of the lower of the two
+// Nyquist frequencies.
+struct ResamplerConfig {
+    double passband      = 0.9;     // flat up to here
+    double stopband      = 1.0;     // attenuated from here; up to 2 - passband
+                                    // lets aliases fold back only above the
+                                    // passband
+    double attenuationDb = 100;     // stopband level, sets the Kaiser beta
+                                    // and, with the transition, the length
+};
+
+// Speed against fidelity when converting rates; passband and stopband
+// attenuation are
+//   fast    0.80 of Nyquist,  60 dB
+//   medium  0.90 of Nyquist,  90 dB
+//   best    0.95 of Nyquist, 120 dB
+// and the filter, and the time per sample, grows with both.
+enum class ResampleQuality { Fast, Medium, Best };
+
+// Parses "fast", "medium" or "best".
+ResampleQuality parseResampleQuality(const std::string& name);
+// The name parseResampleQuality() reads back, for labels and cache keys.
+std::string resampleQualityName(ResampleQuality quality);
+ResamplerConfig resamplerConfig(ResampleQuality quality);
+
+// One design's sub-filters: phase p is taps floats from p * taps on. A
+// ratio needing more than RESAMPLE_MAX_PHASES phases gets fewer, plus a
+// last one equal to phase 0 a sample later, and interpolates between
+// neighbours.
+struct PolyphaseTable {
+    size_t taps = 0;
+    size_t phases = 0;
+    std::vector<float> coefficients;
+};
+
+// Rational polyphase FIR resampler: conceptually up by `up` with zeros
+// stuffed in, a Kaiser-windowed sinc low-pass, then every `down`-th sample
+// kept. Only the kept outputs are computed and the stuffed zeros are never
+// multiplied, so each output is one dot product of tapsPerPhase() inputs
+// with one of `up` sub-filters (phases), read from a table built once per
+// ratio and config and shared by every resampler that uses it.
+// The filter is centred on the output instant, so output n lines up with
+// input time n * down / up; time is kept as an exact fraction, so there is
+// no drift over any length.
+class PolyphaseResampler {
+public:
+    // up and down are reduced by their common divisor first.
+    PolyphaseResampler(size_t up, size_t down, const ResamplerConfig& config = ResamplerConfig());
+
+    size_t up() const { return up_; }
+    size_t down() const { return down_; }
+    size_t tapsPerPhase() const { return taps_; }
+
+    // Resamples `count` samples taken every `stride` floats from src and
+    // appends every output whose inputs have all arrived.
+    void process(const float* src, size_t count, size_t stride, std::vector<float>& out);
+
+    // Appends the outputs still waiting on inputs past the end, treating
+    // them as silence, so N samples in give ceil(N * up / down) out. The
+    // resampler then starts over.
+    void finish(std::vector<float>& out);
+
+private:
+    // Appends outputs while their last input is in input_, then drops the
+    // inputs no later output reaches.
+    void run(std::vector<float>& out);
+    // Back to the start of a stream.
+    void reset();
+
+    size_t up_, down_, taps_;
+    std::shared_ptr<const PolyphaseTable> table_;  // taps reversed
+    std::vector<float> input_;
+    int64_t first_ = 0;             // stream index of input_[0]; negative while
+                                    // the start's zero history is in there
+    uint64_t next_ = 0;             // next output's centre, in 1/up_ inputs
+    uint64_t consumed_ = 0;         // inputs taken in
+    uint64_t produced_ = 0;         // outputs appended
+};
+
+// Block source (same read() contract as AudioFileReader and AudioStream)
+// whose every channel is converted to another rate on the way through.
+// Each read() pulls input blocks until it can fill the request, so only a
+// block or two of samples is ever held: a file can be converted while it
+// is decoded, without a second pass over the whole signal.
+class ResamplingReader {
+public:
+    // `read` fills interleaved frames of `channels` channels at fromRate
+    // and returns how many, fewer only at the end.
+    ResamplingReader(std::function<uint64_t(float*, uint64_t)> read, uint32_t channels,
+                     uint32_t fromRate, uint32_t toRate,
+                     ResampleQuality quality = ResampleQuality::Medium);
+
+    uint32_t sampleRate() const { return rate_; }
+    uint32_t channels() const { return channels_; }
+    // Fills up to `frames` interleaved output frames; fewer means the end.
+    uint64_t read(float* dst, uint64_t frames);
+
+private:
+    std::function<uint64_t(float*, uint64_t)> source_;
+    uint32_t channels_, rate_;
+    std::vector<PolyphaseResampler> resamplers_;
+    std::vector<float> block_;
+    std::vector<std::vector<float>> pending_;  // per channel, from offset_ on
+    size_t offset_ = 0;
+    bool done_ = false;
+};
+
+// loadAudioFile() at `rate`: decoded and converted a block at a time,
+// interleaved. A file already at `rate` is simply loaded, FLAC on
+// `threads` decode threads as in loadAudioFile().
+AudioData loadAudioResampled(const std::string& path, uint32_t rate,
+                             ResampleQuality quality = ResampleQuality::Medium,
+                             Arena* arena = nullptr, unsigned threads = 0);
+
+// loadAudioStream() at `rate`, converted as the data arrives.
+AudioData loadStreamResampled(AudioStream& stream, uint32_t rate,
+                              ResampleQuality quality = ResampleQuality::Medium,
+                              Arena* arena = nullptr);
+
+// Audio already in memory converted to `rate`, into planar data, channels
+// in parallel on up to `threads` threads (0 = workerCount()).
+AudioData resampleChannels(const AudioData& data, uint32_t rate,
+                           ResampleQuality quality = ResampleQuality::Medium,
+                           unsigned threads = 0);
+
+// Top of the band that decimating `rate` by `factor` keeps flat and free
+// of aliases: rate / factor / (2 * DECIMATE_MARGIN), the filter's passband
+// edge. The filter depends on nothing else.
+double decimationBandHz(uint32_t rate, size_t factor);
+
+// Largest factor D that divides `rate` with decimationBandHz(rate, D) at
+// least bandHz; 1 when no factor fits.
+size_t decimationFactor(uint32_t rate, double bandHz);
+
+// Every channel low-passed and decimated by `factor`, into planar data at
+// sampleRate / factor. The filter is designed from the factor alone, so a
+// factor always gives the same spectrum; aliases fold back only above
+// decimationBandHz(). Channels run in parallel on up to `threads` threads
+// (0 = workerCount()).
+AudioData decimateChannels(const AudioData& data, size_t factor, unsigned threads = 0);
+
+#endif
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cachedir.hpp"
+#include "hash.hpp"
+#include "spectrumcache.hpp"
+
+static const char MAGIC[8] = {'D', 'C', 'S', 'P', 'E', 'C', '0', '2'};
+
+struct SpectrumHeader {
+    char     magic[8];
+    uint64_t source;
+    uint64_t fftSize;
+    uint64_t bins;
+    double   binHz;
+    char     window[24];
+};
+static_assert(sizeof(SpectrumHeader) == 64, "spectrum header layout changed");
+
+static void fillHeader(SpectrumHeader& h, const SpectrumKey& key)
+{
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.source  = key.source;
+    h.fftSize = key.fftSize;
+    std::strncpy(h.window, key.window.c_str(), sizeof(h.window) - 1);
+}
+
+SpectrumCache::SpectrumCache(const std::string& dir, uint64_t maxBytes)
+    : dir_(dir), maxBytes_(maxBytes)
+{
+    ensureCacheDir(dir_);
+}
+
+std::string SpectrumCache::entryPath(const SpectrumKey& key) const
+{
+    uint64_t h = hashBytes(key.window.data(), key.window.size(), key.source ^ key.fftSize);
+    return dir_ + "/" + hashHex(h) + ".spec";
+}
+
+bool SpectrumCache::load(const SpectrumKey& key, double lo, double hi, Spectrum& out) const
+{
+    const std::string path = entryPath(key);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    SpectrumHeader h, expected;
+    fillHeader(expected, key);
+    struct stat st;
+    bool ok = ::pread(fd, &h, sizeof(h), 0) == static_cast<ssize_t>(sizeof(h))
+           && fstat(fd, &st) == 0
+           && std::memcmp(h.magic, expected.magic, sizeof(h.magic)) == 0
+           && h.source == expected.source && h.fftSize == expected.fftSize
+           && std::memcmp(h.window, expected.window, sizeof(h.window)) == 0
+           && static_cast<uint64_t>(st.st_size) == sizeof(h) + h.bins * sizeof(double)
+           && h.binHz > 0 && h.bins > 0;
+
+    if (ok) {
+        // read only the requested band
+        uint64_t first = lo > 0 ? static_cast<uint64_t>(std::ceil(lo / h.binHz)) : 0;
+        uint64_t last  = std::min<uint64_t>(h.bins - 1, static_cast<uint64_t>(std::floor(hi / h.binHz)));
+        out.binHz    = h.binHz;
+        out.firstBin = first;
+        out.mag.assign(last >= first ? last - first + 1 : 0, 0.0);
+        const size_t bytes = out.mag.size() * sizeof(double);
+        ok = bytes == 0
+          || ::pread(fd, out.mag.data(), bytes, sizeof(h) + first * sizeof(double)) == static_cast<ssize_t>(bytes);
+    }
+    ::close(fd);
+
+    if (ok)
+        touchCacheEntry(path);
+    return ok;
+}
+
+void SpectrumCache::store(const SpectrumKey& key, double binHz, const std::vector<double>& mag)
+{
+    SpectrumHeader h;
+    fillHeader(h, key);
+    h.bins  = mag.size();
+    h.binHz = binHz;
+
+    if (writeCacheEntry(entryPath(key), &h, sizeof(h), mag.data(), mag.size() * sizeof(double)))
+        evictCacheEntries(dir_, ".spec", maxBytes_);
+}
@@ -0,0 +1,46 @@
+#ifndef SPECTRUMCACHE_HPP
+#define SPECTRUMCACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// What a spectrum depends on: the input's content and the analysis setup.
+struct SpectrumKey {
+    SpectrumKey(uint64_t source, uint64_t fftSize, const std::string& window)
+        : source(source), fftSize(fftSize), window(window) {}
+
+    uint64_t source;        // hashFile() of the input
+    uint64_t fftSize;       // 0 = one transform over the whole file
+    std::string window;
+};
+
+// Magnitudes of bins firstBin, firstBin + 1, ...; bin k sits at k * binHz.
+struct Spectrum {
+    double binHz = 0;
+    uint64_t firstBin = 0;
+    std::vector<double> mag;
+
+    double frequency(size_t i) const { return (firstBin + i) * binHz; }
+};
+
+// One compact binary file per key holding the full half spectrum. The band
+// is not part of the key: any band of a stored spectrum is served by
+// reading just that slice of the entry. Least recently used entries are
+// evicted past maxBytes.
+class SpectrumCache {
+public:
+    explicit SpectrumCache(const std::string& dir, uint64_t maxBytes = 256ULL << 20);
+
+    // Fills `out` with the bins between lo and hi Hz; false on a miss.
+    bool load(const SpectrumKey& key, double lo, double hi, Spectrum& out) const;
+    void store(const SpectrumKey& key, double binHz, const std::vector<double>& mag);
+
+private:
+    std::string entryPath(const SpectrumKey& key) const;
+
+    std::string dir_;
+    uint64_t maxBytes_;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "convert.hpp"
+#include "parallel.hpp"
+#include "stft.hpp"
+
+// Frames per parallelFor task; large enough to amortize the scratch buffer.
+static const size_t STFT_BLOCK_FRAMES = 64;
+
+static size_t checkedFftSize(const StftConfig& config)
+{
+    if (config.windowSize == 0 || config.hop == 0)
+        throw std::runtime_error("stft: window size and hop must be positive");
+    if (config.fftSize == 0)
+        return nextPowerOfTwo(config.windowSize);
+    if (config.fftSize < config.windowSize)
+        throw std::runtime_error("stft: FFT size is smaller than the window");
+    return config.fftSize;
+}
+
+Stft::Stft(const StftConfig& config)
+    : config_(config), plan_(checkedFftSize(config)),
+      window_(windowTable(config.window, config.windowSize)),
+      scale_(2.0 / window_->sum)
+{
+}
+
+size_t Stft::frameCount(size_t samples) const
+{
+    if (config_.center)
+        return samples / config_.hop + 1;
+    if (samples < config_.windowSize)
+        return 0;
+    return (samples - config_.windowSize) / config_.hop + 1;
+}
+
+Spectrogram Stft::compute(const AudioView& signal, unsigned threads) const
+{
+    const size_t n = signal.frames;
+    const size_t size = config_.windowSize;
+    const size_t fftN = plan_.size();
+    const float* window = window_->values.data();
+    const int64_t offset = config_.center ? static_cast<int64_t>(size / 2) : 0;
+
+    Spectrogram out;
+    out.frames = frameCount(n);
+    out.bins   = fftN / 2 + 1;
+    out.binHz  = static_cast<double>(signal.sampleRate) / fftN;
+    out.hopSeconds   = static_cast<double>(config_.hop) / signal.sampleRate;
+    out.startSeconds = config_.center ? 0.0 : static_cast<double>(size) / 2 / signal.sampleRate;
+    out.mag.resize(out.frames * out.bins);
+
+    // first sample of frame f, which may hang off either end of the signal
+    auto startOf = [&](size_t f) { return static_cast<int64_t>(f * config_.hop) - offset; };
+    auto inside  = [&](int64_t start) { return start >= 0 && start + static_cast<int64_t>(size) <= static_cast<int64_t>(n); };
+
+    const size_t blocks = (out.frames + STFT_BLOCK_FRAMES - 1) / STFT_BLOCK_FRAMES;
+    parallelFor(blocks, [&](size_t block) {
+        std::vector<std::complex<double>> xs(fftN), sepA(fftN / 2 + 1), sepB(fftN / 2 + 1);
+        const size_t first = block * STFT_BLOCK_FRAMES;
+        const size_t last  = std::min(out.frames, first + STFT_BLOCK_FRAMES);
+
+        for (size_t f = first; f < last; f += 2) {
+            const bool pair = f + 1 < last;
+            const int64_t a = startOf(f), b = pair ? startOf(f + 1) : 0;
+
+            if (inside(a) && (!pair || inside(b))) {
+                const float* pa = signal.data + a * signal.stride;
+                if (pair)
+                    packComplexPair(pa, signal.data + b * signal.stride, signal.stride, size,
+                                    window, 1.0, xs.data());
+                else
+                    packComplex(pa, signal.stride, size, window, 1.0, xs.data());
+            } else {
+                // frames hanging off an end read zeros there
+                for (size_t i = 0; i < size; ++i) {
+                    const int64_t ia = a + static_cast<int64_t>(i), ib = b + static_cast<int64_t>(i);
+                    const float xa = ia >= 0 && ia < static_cast<int64_t>(n) ? signal[ia] : 0.0f;
+                    const float xb = pair && ib >= 0 && ib < static_cast<int64_t>(n) ? signal[ib] : 0.0f;
+                    xs[i] = {xa * window[i], xb * window[i]};
+                }
+            }
+            std::fill(xs.begin() + size, xs.end(), std::complex<double>(0));
+            plan_.forward(xs.data());
+
+            // Z = A + iB with A, B real: A[k] = (Z[k] + conj Z[N-k]) / 2 and
+            // B[k] = (Z[k] - conj Z[N-k]) / 2i; the halves are folded into
+            // the kernel's scale and the 1/i does not change magnitudes
+            for (size_t k = 0; k < out.bins; ++k) {
+                const std::complex<double> z = xs[k], zc = std::conj(xs[(fftN - k) & (fftN - 1)]);
+                sepA[k] = z + zc;
+                sepB[k] = z - zc;
+            }
+            float* row = out.mag.data() + f * out.bins;
+            complexToSpectrum(sepA.data(), out.bins, 0.5 * scale_, config_.scale, config_.floorDb, row);
+            if (pair)
+                complexToSpectrum(sepB.data(), out.bins, 0.5 * scale_, config_.scale, config_.floorDb,
+                                  row + out.bins);
+        }
+    }, threads);
+    return out;
+}
@@ -0,0 +1,65 @@
+#ifndef STFT_HPP
+#define STFT_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "audio.hpp"
+#include "convert.hpp"
+#include "fft.hpp"
+#include "window.hpp"
+
+struct StftConfig {
+    size_t windowSize = 2048;
+    size_t hop        = 512;
+    size_t fftSize    = 0;          // 0 = windowSize rounded up to a power of two;
+                                    // larger powers zero-pad every frame
+    WindowSpec window;              // Hann unless set
+    bool center       = true;       // pad windowSize / 2 zeros at both ends so
+                                    // frame f is centred on sample f * hop
+    SpectrumScale scale = SpectrumScale::Magnitude;
+    double floorDb    = -120;       // lowest value written in Decibels mode
+};
+
+// Magnitudes of a short-time Fourier transform, frames × bins, row-major:
+// row f holds frame f's single-sided spectrum scaled so a full-scale
+// sinusoid reads 1.0 under any window, or its power or dB value when the
+// config asks for one.
+struct Spectrogram {
+    size_t frames = 0;
+    size_t bins   = 0;
+    double binHz      = 0;          // bin k sits at k * binHz
+    double hopSeconds = 0;
+    double startSeconds = 0;        // centre of frame 0
+    std::vector<float> mag;
+
+    const float* frame(size_t f) const { return mag.data() + f * bins; }
+    double time(size_t f) const { return startSeconds + f * hopSeconds; }
+};
+
+// STFT engine for one configuration. The FFT plan is built once in the
+// constructor and the window comes from the shared table cache; both are
+// read-only for every frame, so one
+// engine serves any number of signals and threads.
+class Stft {
+public:
+    explicit Stft(const StftConfig& config);
+
+    const StftConfig& config() const { return config_; }
+    size_t fftSize() const { return plan_.size(); }
+    size_t frameCount(size_t samples) const;
+
+    // Transforms the view, spreading blocks of frames over up to `threads`
+    // threads (0 = workerCount()). Real frames go through the FFT two at a
+    // time, one as the real part and one as the imaginary part, and are
+    // separated by symmetry afterwards.
+    Spectrogram compute(const AudioView& signal, unsigned threads = 0) const;
+
+private:
+    StftConfig config_;
+    FftPlan plan_;
+    std::shared_ptr<const WindowTable> window_;
+    double scale_;                  // amplitude correction, 2 / sum(window)
+};
+
+#endif
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "dr_libs-master/dr_wav.h"
+#include "convert.hpp"
+#include "stream.hpp"
+
+// Frames decoded per step while loading a whole stream.
+static const uint64_t STREAM_BLOCK_FRAMES = 16384;
+
+RawFormat parseRawFormat(const std::string& spec)
+{
+    RawFormat format;
+    unsigned rate = 0, channels = 0;
+    char encoding[8] = {0};
+    if (std::sscanf(spec.c_str(), "%u:%u:%7s", &rate, &channels, encoding) != 3
+        || rate == 0 || channels == 0)
+        throw std::runtime_error("raw: expected RATE:CHANNELS:ENCODING, got " + spec);
+
+    const std::string enc = encoding;
+    if (enc == "s16")
+        format.encoding = RawEncoding::S16;
+    else if (enc == "s24")
+        format.encoding = RawEncoding::S24;
+    else if (enc == "s32")
+        format.encoding = RawEncoding::S32;
+    else if (enc == "f32")
+        format.encoding = RawEncoding::F32;
+    else
+        throw std::runtime_error("raw: unknown encoding " + enc);
+    format.sampleRate = rate;
+    format.channels   = channels;
+    return format;
+}
+
+static size_t bytesPerSample(RawEncoding encoding)
+{
+    switch (encoding) {
+    case RawEncoding::S16: return 2;
+    case RawEncoding::S24: return 3;
+    default:               return 4;
+    }
+}
+
+struct AudioStream::Wav {
+    drwav wav;
+
+    static size_t onRead(void* self, void* dst, size_t bytes)
+    {
+        return static_cast<AudioStream*>(self)->readBytes(dst, bytes);
+    }
+
+    // A pipe cannot rewind, so only seeks at or past the cursor are
+    // honoured, by reading and discarding. dr_wav uses them to step over
+    // chunks and, even in sequential mode, to "return" to the data chunk
+    // it is already at.
+    static drwav_bool32 onSeek(void* self, int offset, drwav_seek_origin origin)
+    {
+        AudioStream* stream = static_cast<AudioStream*>(self);
+        int64_t skip = offset;
+        if (origin == drwav_seek_origin_start)
+            skip -= static_cast<int64_t>(stream->pos_);
+        if (skip < 0)
+            return DRWAV_FALSE;
+        char sink[4096];
+        size_t left = static_cast<size_t>(skip);
+        while (left > 0) {
+            size_t step = std::min(left, sizeof(sink));
+            if (stream->readBytes(sink, step) != step)
+                return DRWAV_FALSE;
+            left -= step;
+        }
+        return DRWAV_TRUE;
+    }
+};
+
+AudioStream::AudioStream(int fd) : fd_(fd), wav_(new Wav)
+{
+    // sequential: never seek backwards to revisit chunks
+    if (!drwav_init_ex(&wav_->wav, &Wav::onRead, &Wav::onSeek, nullptr,
+                       this, nullptr, DRWAV_SEQUENTIAL, nullptr))
+        throw std::runtime_error("dr_wav: cannot read stream header");
+    sampleRate_ = wav_->wav.sampleRate;
+    channels_   = wav_->wav.channels;
+}
+
+AudioStream::AudioStream(int fd, const RawFormat& format)
+    : fd_(fd), sampleRate_(format.sampleRate), channels_(format.channels), encoding_(format.encoding)
+{
+}
+
+AudioStream::~AudioStream()
+{
+    if (wav_)
+        drwav_uninit(&wav_->wav);
+}
+
+// Pipes return whatever is buffered, so keep reading until the request is
+// filled or the writer closes its end.
+size_t AudioStream::readBytes(void* dst, size_t bytes)
+{
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t got = ::read(fd_, static_cast<char*>(dst) + done, bytes - done);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            break;
+        done += static_cast<size_t>(got);
+    }
+    pos_ += done;
+    return done;
+}
+
+uint64_t AudioStream::read(float* dst, uint64_t frames)
+{
+    if (wav_)
+        return drwav_read_pcm_frames_f32(&wav_->wav, frames, dst);
+
+    const size_t width = bytesPerSample(encoding_);
+    const size_t frameBytes = width * channels_;
+    raw_.resize(frames * frameBytes);
+    // a truncated last frame is dropped
+    const size_t got = readBytes(raw_.data(), raw_.size()) / frameBytes;
+    const size_t samples = got * channels_;
+
+    switch (encoding_) {
+    case RawEncoding::S16:
+        s16ToF32(reinterpret_cast<const int16_t*>(raw_.data()), samples, 1.0f / 32768.0f, dst);
+        break;
+    case RawEncoding::S24:
+        s24ToF32(raw_.data(), samples, 1.0f / 8388608.0f, dst);
+        break;
+    case RawEncoding::S32:
+        s32ToF32(reinterpret_cast<const int32_t*>(raw_.data()), samples, 1.0f / 2147483648.0f, dst);
+        break;
+    case RawEncoding::F32:
+        std::copy(raw_.data(), raw_.data() + samples * 4, reinterpret_cast<unsigned char*>(dst));
+        break;
+    }
+    return got;
+}
+
+AudioData loadAudioStream(AudioStream& stream, Arena* arena)
+{
+    AudioData out(arena);
+    out.sampleRate = stream.sampleRate();
+    out.channels   = stream.channels();
+
+    // the length is unknown up front, so grow one block at a time
+    uint64_t frames = 0;
+    for (;;) {
+        out.samples.resize((frames + STREAM_BLOCK_FRAMES) * out.channels);
+        uint64_t got = stream.read(out.samples.data() + frames * out.channels, STREAM_BLOCK_FRAMES);
+        frames += got;
+        if (got < STREAM_BLOCK_FRAMES)
+            break;
+    }
+    out.samples.resize(frames * out.channels);
+    return out;
+}
+
+bool isStreamPath(const std::string& path)
+{
+    if (path == "-")
+        return true;
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && (S_ISFIFO(st.st_mode) || S_ISCHR(st.st_mode));
+}
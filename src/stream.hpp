@@ -0,0 +1,67 @@
+#ifndef STREAM_HPP
+#define STREAM_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "audio.hpp"
+
+// Sample encoding of headerless little-endian PCM.
+enum class RawEncoding { S16, S24, S32, F32 };
+
+struct RawFormat {
+    uint32_t    sampleRate = 44100;
+    uint32_t    channels   = 2;
+    RawEncoding encoding   = RawEncoding::S16;
+};
+
+// Parses "RATE:CHANNELS:ENCODING", e.g. "48000:1:s24"; encodings are
+// s16, s24, s32 and f32. Throws std::runtime_error on anything else.
+RawFormat parseRawFormat(const std::string& spec);
+
+// Audio read front to back from a pipe, FIFO or terminal: stdin fed by
+// ffmpeg or arecord, or a named pipe. Nothing is ever sought backwards and
+// nothing is buffered beyond one read, so frames are available as soon as
+// their bytes arrive. WAV input goes through dr_wav in sequential mode;
+// raw input is converted directly.
+class AudioStream {
+public:
+    // Reads a WAV stream, header first, from `fd`.
+    explicit AudioStream(int fd);
+    // Reads headerless PCM in `format` from `fd`.
+    AudioStream(int fd, const RawFormat& format);
+    ~AudioStream();
+    AudioStream(const AudioStream&) = delete;
+    AudioStream& operator=(const AudioStream&) = delete;
+
+    uint32_t sampleRate() const { return sampleRate_; }
+    uint32_t channels() const { return channels_; }
+
+    // Decodes up to `frames` interleaved f32 frames into dst, blocking
+    // until they arrive. Returns fewer only at the end of the stream.
+    uint64_t read(float* dst, uint64_t frames);
+
+private:
+    struct Wav;     // dr_wav decoder and its callbacks
+
+    size_t readBytes(void* dst, size_t bytes);
+
+    int fd_;
+    uint64_t pos_ = 0;              // bytes consumed so far
+    uint32_t sampleRate_ = 0;
+    uint32_t channels_   = 0;
+    RawEncoding encoding_ = RawEncoding::F32;
+    std::unique_ptr<Wav> wav_;      // null for raw input
+    std::vector<unsigned char> raw_;
+};
+
+// Reads a stream to its end into memory, growing the buffer block by block
+// as data arrives.
+AudioData loadAudioStream(AudioStream& stream, Arena* arena = nullptr);
+
+// True for "-" (stdin) and for paths naming a FIFO or character device,
+// which have to be read as streams rather than opened by extension.
+bool isStreamPath(const std::string& path);
+
+#endif
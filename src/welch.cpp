@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <stdexcept>
+#include "welch.hpp"
+
+// Segments per Stft call. Even, so the Stft's two-frames-per-FFT pairing
+// always falls on the same segments.
+static const size_t WELCH_BATCH = 64;
+
+static StftConfig stftConfig(const WelchConfig& config)
+{
+    if (config.segment == 0 || config.hop == 0 || config.hop > config.segment)
+        throw std::runtime_error("welch: hop must be between 1 and the segment length");
+    StftConfig c;
+    c.windowSize = config.segment;
+    c.hop        = config.hop;
+    c.window     = config.window;
+    c.center     = false;
+    c.scale      = SpectrumScale::Power;
+    return c;
+}
+
+Welch::Welch(const WelchConfig& config, uint32_t sampleRate, unsigned threads)
+    : config_(config), sampleRate_(sampleRate), threads_(threads),
+      stft_(stftConfig(config)), sum_(bins(), 0.0)
+{
+    if (sampleRate == 0)
+        throw std::runtime_error("welch: sample rate must be positive");
+}
+
+void Welch::push(const float* src, size_t count, size_t stride)
+{
+    const size_t batchSamples = (WELCH_BATCH - 1) * config_.hop + config_.segment;
+    while (count > 0) {
+        // top the buffer up to one batch, so it never grows past that
+        const size_t take = std::min(count, batchSamples - std::min(batchSamples, buffer_.size()));
+        for (size_t i = 0; i < take; ++i)
+            buffer_.push_back(src[i * stride]);
+        src += take * stride;
+        count -= take;
+        if (buffer_.size() >= batchSamples)
+            consume(WELCH_BATCH);
+    }
+}
+
+// Adds the powers of `count` segments starting at the buffer's front to
+// `sum`, one segment after another.
+static void accumulate(const Stft& stft, const std::vector<float>& buffer, size_t count,
+                       uint32_t sampleRate, unsigned threads, std::vector<double>& sum)
+{
+    const StftConfig& c = stft.config();
+    AudioView view(buffer.data(), (count - 1) * c.hop + c.windowSize, 1, sampleRate);
+    const Spectrogram power = stft.compute(view, threads);
+    for (size_t f = 0; f < power.frames; ++f) {
+        const float* row = power.frame(f);
+        for (size_t k = 0; k < power.bins; ++k)
+            sum[k] += row[k];
+    }
+}
+
+void Welch::consume(size_t count)
+{
+    accumulate(stft_, buffer_, count, sampleRate_, threads_, sum_);
+    segments_ += count;
+    buffer_.erase(buffer_.begin(), buffer_.begin() + count * config_.hop);
+}
+
+// Complete segments waiting in a buffer of `size` samples.
+static size_t pendingSegments(size_t size, const WelchConfig& config)
+{
+    return size >= config.segment ? (size - config.segment) / config.hop + 1 : 0;
+}
+
+uint64_t Welch::segments() const
+{
+    return segments_ + pendingSegments(buffer_.size(), config_);
+}
+
+std::vector<double> Welch::psd() const
+{
+    // complete segments still in the buffer count too, without consuming
+    // them, so asking early does not change what later pushes produce
+    std::vector<double> out = sum_;
+    const size_t pending = pendingSegments(buffer_.size(), config_);
+    if (pending > 0)
+        accumulate(stft_, buffer_, pending, sampleRate_, threads_, out);
+    const uint64_t segments = segments_ + pending;
+    if (segments == 0)
+        return std::vector<double>(bins(), 0.0);
+
+    // The Stft's power is (2 |X| / S1)^2 with S1 = sum(w). A one-sided
+    // density is 2 |X|^2 / (fs * S2) with S2 = sum(w^2), and half that at
+    // DC and Nyquist, which have no mirror image.
+    const std::shared_ptr<const WindowTable> w = windowTable(config_.window, config_.segment);
+    const double density = w->sum * w->sum / (2.0 * sampleRate_ * w->sumSquares) / segments;
+    const size_t last = out.size() - 1;
+    for (size_t k = 0; k < out.size(); ++k)
+        out[k] *= (k == 0 || k == last) && stft_.fftSize() > 1 ? density / 2 : density;
+    return out;
+}
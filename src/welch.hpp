@@ -0,0 +1,58 @@
+#ifndef WELCH_HPP
+#define WELCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "stft.hpp"
+#include "window.hpp"
+
+struct WelchConfig {
+    size_t segment = 4096;          // samples per segment; the FFT rounds
+                                    // up to a power of two
+    size_t hop     = 2048;          // segment start to start, 1..segment
+    WindowSpec window;              // Hann unless set
+};
+
+// Welch power spectral density estimate, built up as samples arrive. Each
+// complete segment is windowed, transformed and its power added to a
+// running sum; only the tail that later segments still overlap is kept,
+// so memory is a few segments whatever the input length.
+//
+// Segments are transformed WELCH_BATCH at a time by an Stft spread over
+// `threads` threads, and each batch is summed into the total in segment
+// order. The grouping depends only on the segment count, so the estimate
+// is the same for any thread count and any split of the input into
+// push() calls.
+class Welch {
+public:
+    Welch(const WelchConfig& config, uint32_t sampleRate, unsigned threads = 0);
+
+    // Appends `count` samples taken every `stride` floats from src; pass
+    // src + c and stride = channels to feed channel c of interleaved frames.
+    void push(const float* src, size_t count, size_t stride = 1);
+
+    // One-sided PSD in units^2 per Hz over all complete segments so far,
+    // bin k at k * binHz(); a trailing partial segment is left out.
+    std::vector<double> psd() const;
+
+    double binHz() const { return static_cast<double>(sampleRate_) / stft_.fftSize(); }
+    size_t bins() const { return stft_.fftSize() / 2 + 1; }
+    // Complete segments so far.
+    uint64_t segments() const;
+
+private:
+    // Transforms the first `count` segments in the buffer, adds them to
+    // the sum and drops the samples no later segment needs.
+    void consume(size_t count);
+
+    WelchConfig config_;
+    uint32_t sampleRate_;
+    unsigned threads_;
+    Stft stft_;
+    std::vector<float> buffer_;     // samples from the next segment's start on
+    std::vector<double> sum_;       // per-bin power over consumed segments
+    uint64_t segments_ = 0;         // segments in sum_
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include "window.hpp"
+
+// Floats the table cache keeps before it drops tables nobody holds.
+static const size_t WINDOW_CACHE_FLOATS = size_t(16) << 20;
+
+WindowSpec parseWindow(const std::string& name)
+{
+    if (name == "rect")
+        return WindowSpec(WindowType::Rectangular);
+    if (name == "hann")
+        return WindowSpec(WindowType::Hann);
+    if (name == "hamming")
+        return WindowSpec(WindowType::Hamming);
+    if (name == "blackman-harris")
+        return WindowSpec(WindowType::BlackmanHarris);
+    if (name == "flattop")
+        return WindowSpec(WindowType::FlatTop);
+    if (name == "kaiser")
+        return WindowSpec(WindowType::Kaiser);
+    if (name.compare(0, 7, "kaiser:") == 0) {
+        double beta = std::stod(name.substr(7));
+        if (!(beta >= 0))
+            throw std::runtime_error("window: Kaiser beta must not be negative");
+        return WindowSpec(WindowType::Kaiser, beta);
+    }
+    throw std::runtime_error("window: unknown window " + name);
+}
+
+std::string windowName(const WindowSpec& spec)
+{
+    switch (spec.type) {
+    case WindowType::Rectangular:    return "rect";
+    case WindowType::Hann:           return "hann";
+    case WindowType::Hamming:        return "hamming";
+    case WindowType::BlackmanHarris: return "blackman-harris";
+    case WindowType::FlatTop:        return "flattop";
+    case WindowType::Kaiser: {
+        // the fewest digits that read back as exactly this beta, so two
+        // betas never share a cache key
+        std::ostringstream beta;
+        for (int digits = 6; digits <= 17; ++digits) {
+            beta.str("");
+            beta << std::setprecision(digits) << spec.param;
+            if (std::stod(beta.str()) == spec.param)
+                break;
+        }
+        return "kaiser" + beta.str();
+    }
+    }
+    return "";
+}
+
+// Modified Bessel function of the first kind, order 0, by its power
+// series; the terms shrink fast enough for any practical beta.
+static double besselI0(double x)
+{
+    double sum = 1, term = 1;
+    const double q = x * x / 4;
+    for (int k = 1; k < 200; ++k) {
+        term *= q / (static_cast<double>(k) * k);
+        sum += term;
+        if (term < sum * 1e-17)
+            break;
+    }
+    return sum;
+}
+
+// Sum of cosines a0 - a1 cos(x) + a2 cos(2x) - ...
+static double cosineSum(const double* a, int terms, double x)
+{
+    double w = 0, sign = 1;
+    for (int k = 0; k < terms; ++k, sign = -sign)
+        w += sign * a[k] * std::cos(k * x);
+    return w;
+}
+
+static std::shared_ptr<WindowTable> buildTable(const WindowSpec& spec, size_t size)
+{
+    static const double hann[]    = { 0.5, 0.5 };
+    static const double hamming[] = { 0.54, 0.46 };
+    static const double blackmanHarris[] = { 0.35875, 0.48829, 0.14128, 0.01168 };
+    static const double flatTop[] = { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 };
+    const double pi = std::acos(-1.0);
+
+    std::shared_ptr<WindowTable> table = std::make_shared<WindowTable>();
+    std::vector<float>& w = table->values;
+    w.assign(size, 1.0f);
+    const double i0Beta = besselI0(spec.param);
+    for (size_t i = 0; i < size; ++i) {
+        const double x = 2 * pi * i / size;
+        switch (spec.type) {
+        case WindowType::Rectangular:    break;
+        case WindowType::Hann:           w[i] = static_cast<float>(cosineSum(hann, 2, x)); break;
+        case WindowType::Hamming:        w[i] = static_cast<float>(cosineSum(hamming, 2, x)); break;
+        case WindowType::BlackmanHarris: w[i] = static_cast<float>(cosineSum(blackmanHarris, 4, x)); break;
+        case WindowType::FlatTop:        w[i] = static_cast<float>(cosineSum(flatTop, 5, x)); break;
+        case WindowType::Kaiser: {
+            // periodic: the symmetric window of size + 1 points minus its last
+            const double r = 2.0 * i / size - 1.0;
+            w[i] = static_cast<float>(besselI0(spec.param * std::sqrt(1 - r * r)) / i0Beta);
+            break;
+        }
+        }
+    }
+    for (float v : w) {
+        table->sum += v;
+        table->sumSquares += static_cast<double>(v) * v;
+    }
+    return table;
+}
+
+std::shared_ptr<const WindowTable> windowTable(const WindowSpec& spec, size_t size)
+{
+    typedef std::tuple<int, double, size_t> Key;
+    static std::mutex lock;
+    static std::map<Key, std::shared_ptr<const WindowTable>> tables;
+    static size_t cachedFloats = 0;
+
+    const double param = spec.type == WindowType::Kaiser ? spec.param : 0.0;
+    const Key key(static_cast<int>(spec.type), param, size);
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = tables.find(key);
+    if (it != tables.end())
+        return it->second;
+
+    if (cachedFloats + size > WINDOW_CACHE_FLOATS) {
+        for (auto t = tables.begin(); t != tables.end(); ) {
+            if (t->second.use_count() == 1) {
+                cachedFloats -= t->second->values.size();
+                t = tables.erase(t);
+            } else {
+                ++t;
+            }
+        }
+    }
+    std::shared_ptr<const WindowTable> table = buildTable(spec, size);
+    tables[key] = table;
+    cachedFloats += size;
+    return table;
+}
@@ -0,0 +1,43 @@
+#ifndef WINDOW_HPP
+#define WINDOW_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class WindowType { Rectangular, Hann, Hamming, BlackmanHarris, Kaiser, FlatTop };
+
+// A window shape; `param` is the Kaiser beta and is ignored by the others.
+struct WindowSpec {
+    WindowType type = WindowType::Hann;
+    double param    = 8.6;
+
+    WindowSpec() {}
+    WindowSpec(WindowType t, double p = 8.6) : type(t), param(p) {}
+};
+
+// Parses "rect", "hann", "hamming", "blackman-harris", "flattop" or
+// "kaiser[:BETA]".
+WindowSpec parseWindow(const std::string& name);
+
+// Short name for labels and cache keys: "hann", "kaiser8.6", ... A Kaiser
+// beta is written with as many digits as it takes to be exact.
+std::string windowName(const WindowSpec& spec);
+
+// A periodic window of `values.size()` points, as spectral analysis wants:
+// the sequence repeats with that period, so Hann frames at half-window
+// hops sum to a constant.
+struct WindowTable {
+    std::vector<float> values;
+    double sum        = 0;          // coherent gain times size: amplitude scale
+    double sumSquares = 0;          // power scale, for densities
+};
+
+// The table for `spec` at `size` points. Tables are built once per
+// (shape, size) and shared; the returned pointer stays valid as long as
+// it is held. The cache drops unused tables once it outgrows
+// WINDOW_CACHE_FLOATS, so whole-file windows don't pile up.
+std::shared_ptr<const WindowTable> windowTable(const WindowSpec& spec, size_t size);
+
+#endif